@@ -0,0 +1,123 @@
+#ifndef OREORE_BINARY_PROTOCOL_HPP
+#define OREORE_BINARY_PROTOCOL_HPP
+
+#include <stdint.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace oreore
+{
+    // Frame layout (all integers little-endian):
+    //   offset 0  : uint8_t  opcode
+    //   offset 1  : uint8_t  status   (0 in requests)
+    //   offset 2  : uint16_t reserved (0)
+    //   offset 4  : uint32_t request_id (echoed back in the response)
+    //   offset 8  : uint32_t payload_length
+    //   offset 12 : payload_length bytes of payload
+    inline constexpr size_t   BINARY_HEADER_SIZE       = 12;
+    inline constexpr uint32_t MAX_BINARY_PAYLOAD_SIZE  = 16 * 1024 * 1024;
+    inline constexpr const char BINARY_HANDSHAKE_LINE[] = "BINARY";
+
+    enum class binary_opcode : uint8_t
+    {
+        post  = 0x01, // payload: raw message text
+        get   = 0x02, // payload: empty, or uint64_t version (conditional GET)
+        happy = 0x03, // payload: uint64_t message id
+        sad   = 0x04, // payload: uint64_t message id
+        // payload: repeated { uint32_t length; length bytes of text };
+        // response: uint64_t id of the first message in the posted range
+        post_batch = 0x05,
+        // Router -> shard node only. payload: uint8_t sender_length, the
+        // sender, then a text command run as if that sender had sent it:
+        // one command line, or "MPOST" followed by one line per message.
+        // response: the text reply
+        routed = 0x06,
+        // Router -> shard node, the first frame on the link. payload: the
+        // cluster secret. A node that does not accept it closes the
+        // connection; routed frames are refused on links that never sent it.
+        // response: empty
+        router_hello = 0x07,
+    };
+
+    enum class binary_status : uint8_t
+    {
+        ok    = 0x00,
+        error = 0x01,
+    };
+
+    struct binary_frame_header
+    {
+        binary_opcode opcode;
+        binary_status status;
+        uint32_t      request_id;
+        uint32_t      payload_length;
+    };
+
+    inline auto load_le32(const char *source) -> uint32_t
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(source);
+        return static_cast<uint32_t>(bytes[0])
+             | (static_cast<uint32_t>(bytes[1]) << 8)
+             | (static_cast<uint32_t>(bytes[2]) << 16)
+             | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    inline auto load_le64(const char *source) -> uint64_t
+    {
+        return static_cast<uint64_t>(load_le32(source))
+             | (static_cast<uint64_t>(load_le32(source + 4)) << 32);
+    }
+
+    inline auto store_le32(char *destination, uint32_t value) -> void
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            destination[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+        }
+    }
+
+    inline auto store_le64(char *destination, uint64_t value) -> void
+    {
+        store_le32(destination, static_cast<uint32_t>(value));
+        store_le32(destination + 4, static_cast<uint32_t>(value >> 32));
+    }
+
+    // Returns std::nullopt until a complete header is available.
+    auto decode_binary_header(std::string_view buffer)
+        -> std::optional<binary_frame_header>;
+
+    // A payload over MAX_BINARY_PAYLOAD_SIZE is replaced by an error
+    // payload saying so, with status error.
+    auto encode_binary_frame(
+        binary_opcode    opcode,
+        binary_status    status,
+        uint32_t         request_id,
+        std::string_view payload
+    ) -> std::string;
+
+    auto encode_binary_id(uint64_t id) -> std::string;
+
+    // Lower-case opcode name for logs and traces, or "unknown".
+    auto binary_opcode_name(binary_opcode opcode) -> std::string_view;
+
+    // Splits a post_batch payload; std::nullopt if a length overruns it.
+    auto decode_binary_batch(std::string_view payload)
+        -> std::optional<std::vector<std::string>>;
+
+    struct routed_command
+    {
+        std::string_view sender_ip;
+        std::string_view command;
+    };
+
+    auto encode_routed_command(std::string_view sender_ip, std::string_view command)
+        -> std::string;
+    // Views into payload; std::nullopt if the sender overruns it.
+    auto decode_routed_command(std::string_view payload)
+        -> std::optional<routed_command>;
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef OREORE_BUFFER_POOL_HPP
+#define OREORE_BUFFER_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace oreore
+{
+    inline constexpr size_t POOL_SLAB_SIZE      = 2 * 1024 * 1024;
+    inline constexpr size_t POOL_MIN_BLOCK_SIZE = 64;
+    inline constexpr size_t POOL_CLASS_COUNT    = 11; // 64 B .. 64 KiB
+
+    struct buffer_pool_stats
+    {
+        struct size_class
+        {
+            size_t block_size;
+            size_t in_use;
+            size_t free;
+        };
+
+        size_t                                  slab_count;
+        size_t                                  reserved_bytes;
+        bool                                    huge_pages;
+        std::array<size_class, POOL_CLASS_COUNT> classes;
+        size_t                                  oversize_in_use;
+    };
+
+    // Per-thread, size-classed block allocator. Blocks are carved from large
+    // slabs and recycled LIFO, so the most recently freed (cache-warm) block
+    // is handed out first. Slabs are aligned to their size and start with
+    // the owning pool, so a block freed on another thread goes back to that
+    // pool through a lock-free list, which the owner drains when it runs out
+    // of free blocks. Until then such blocks still count as in use.
+    class buffer_pool
+    {
+      private:
+        // A block on its way back from another thread.
+        struct returned_block
+        {
+            returned_block *next;
+            size_t          index;
+        };
+
+        std::array<std::vector<void *>, POOL_CLASS_COUNT> free_lists;
+        std::array<size_t, POOL_CLASS_COUNT>              in_use_counts;
+        std::atomic<size_t>                               oversize_in_use;
+        std::atomic<returned_block *>                     returned;
+        char                                             *slab_cursor;
+        char                                             *slab_end;
+        size_t                                            slab_count;
+
+        buffer_pool(void);
+
+        auto carve(size_t block_size) -> void *;
+        // Moves blocks freed by other threads onto the free lists.
+        auto reclaim_returned(void) -> void;
+
+      public:
+        buffer_pool(const buffer_pool &)                     = delete;
+        auto operator=(const buffer_pool &) -> buffer_pool & = delete;
+
+        // The calling thread's pool.
+        static auto local(void) -> buffer_pool &;
+        // Back future slabs with huge pages where the system allows it.
+        static auto set_huge_pages(bool enabled) -> void;
+
+        auto allocate(size_t bytes) -> void *;
+        auto deallocate(void *block, size_t bytes) -> void;
+        [[nodiscard]] auto get_stats(void) const -> buffer_pool_stats;
+    };
+
+    template <typename T>
+    class pool_allocator
+    {
+      public:
+        using value_type = T;
+
+        pool_allocator(void) noexcept = default;
+
+        template <typename U>
+        pool_allocator(const pool_allocator<U> &) noexcept
+        {
+        }
+
+        auto allocate(size_t count) -> T *
+        {
+            return static_cast<T *>(buffer_pool::local().allocate(count * sizeof(T))
+            );
+        }
+
+        auto deallocate(T *pointer, size_t count) noexcept -> void
+        {
+            buffer_pool::local().deallocate(pointer, count * sizeof(T));
+        }
+
+        template <typename U>
+        auto operator==(const pool_allocator<U> &) const noexcept -> bool
+        {
+            return true;
+        }
+    };
+
+    using pooled_string
+        = std::basic_string<char, std::char_traits<char>, pool_allocator<char>>;
+
+}
+
+#endif
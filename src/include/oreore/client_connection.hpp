@@ -1,24 +1,72 @@
 #ifndef OREORE_CLIENT_CONNECTION_HPP
 #define OREORE_CLIENT_CONNECTION_HPP
 
+#include <oreore/buffer_pool.hpp>
+#include <oreore/compression.hpp>
+#include <oreore/task.hpp>
+
+#include <coroutine>
 #include <expected>
-#include <oreore/ip_address.hpp>
+#include <optional>
+#include <oreore/peer_address.hpp>
 #include <oreore/scoped_file_descriptor.hpp>
 #include <string>
+#include <vector>
 
 namespace oreore
 {
 
+    enum class protocol_mode : uint8_t
+    {
+        text,
+        binary,
+    };
+
+    enum class batch_kind : uint8_t
+    {
+        none,
+        mpost,   // MPOST <n>: the next n lines are raw message payloads
+        batch,   // BATCH ... END: mixed commands applied together
+        discard, // an oversized BATCH: the rest is dropped through END
+    };
+
+    struct pending_batch
+    {
+        batch_kind               kind      = batch_kind::none;
+        size_t                   remaining = 0;
+        std::string              tag;
+        std::vector<std::string> lines;
+    };
+
     class client_connection
     {
       private:
         scoped_file_descriptor current_fd;
-        ip_address             current_ip_address;
-        std::string            read_buffer;
-        std::string            write_buffer;
+        peer_address           current_peer_address;
+        pooled_string          read_buffer;
+        pooled_string          write_buffer;
         bool                   writing_registered;
+        protocol_mode          current_protocol_mode;
+        compression_mode       current_compression_mode;
+        // Set once the peer proved it is this node's router; only then are
+        // routed frames, which name their own sender, accepted.
+        bool                   router_peer;
+        // Whether the input read last was sampled for the trace; the
+        // commands it carries and their replies follow that decision.
+        bool                   traced;
+        pending_batch          current_batch;
+        // Next replication sequence to stream, set once the peer subscribed.
+        std::optional<uintmax_t> replica_sequence;
+        // Where the connection's coroutine is parked, if it is waiting on
+        // the socket.
+        std::coroutine_handle<> input_waiter;
+        std::coroutine_handle<> flush_waiter;
+        // Declared last so the coroutine frame goes first on destruction.
+        // It holds references to this object, so it is only started once
+        // the connection sits at its final address in the server's map.
+        task<> connection_task;
 
-        client_connection(int target_fd, oreore::ip_address &&target_ip);
+        client_connection(int target_fd, oreore::peer_address &&target_peer);
 
       public:
         client_connection(void)                      = delete;
@@ -28,14 +76,28 @@ namespace oreore
         client_connection(client_connection &&other) noexcept;
         auto operator=(client_connection &&other) noexcept -> client_connection &;
 
-        static auto make(int target_fd, oreore::ip_address &&target_ip)
+        static auto make(int target_fd, oreore::peer_address &&target_peer)
             -> std::expected<client_connection, std::string>;
 
         [[nodiscard]] auto get_fd(void) const -> int;
-        [[nodiscard]] auto get_ip_string(void) const -> std::string;
-        auto               get_read_buffer(void) -> std::string &;
-        auto               get_write_buffer(void) -> std::string &;
+        [[nodiscard]] auto get_peer_string(void) const -> std::string;
+        [[nodiscard]] auto is_local_peer(void) const -> bool;
+        auto               get_read_buffer(void) -> pooled_string &;
+        auto               get_write_buffer(void) -> pooled_string &;
         auto               is_writing_registered(void) -> bool &;
+        [[nodiscard]] auto get_protocol_mode(void) const -> protocol_mode;
+        auto               set_protocol_mode(protocol_mode mode) -> void;
+        [[nodiscard]] auto get_compression_mode(void) const -> compression_mode;
+        auto               set_compression_mode(compression_mode mode) -> void;
+        [[nodiscard]] auto is_router_peer(void) const -> bool;
+        auto               set_router_peer(bool is_router) -> void;
+        [[nodiscard]] auto is_traced(void) const -> bool;
+        auto               set_traced(bool sampled) -> void;
+        auto               get_pending_batch(void) -> pending_batch &;
+        auto get_replica_sequence(void) -> std::optional<uintmax_t> &;
+        auto get_input_waiter(void) -> std::coroutine_handle<> &;
+        auto get_flush_waiter(void) -> std::coroutine_handle<> &;
+        auto get_task(void) -> task<> &;
     };
 
 }
@@ -0,0 +1,178 @@
+#ifndef OREORE_CLUSTER_HPP
+#define OREORE_CLUSTER_HPP
+
+#include <oreore/binary_protocol.hpp>
+#include <oreore/outbound_socket.hpp>
+#include <oreore/scoped_file_descriptor.hpp>
+
+#include <expected>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace oreore
+{
+    struct message_filter;
+
+    // A cluster splits the board across shard nodes. Each node owns the
+    // IDs whose low SHARD_ID_BITS bits hold its shard index:
+    //   id = (per-shard sequence << SHARD_ID_BITS) | shard index
+    // so any node or router can tell from an ID where the message lives,
+    // and IDs from different shards still sort roughly by posting order.
+    inline constexpr unsigned SHARD_ID_BITS = 8;
+    inline constexpr size_t   MAX_SHARDS    = size_t { 1 } << SHARD_ID_BITS;
+    // Points per shard on the placement ring; more points even out the
+    // share of senders each shard receives.
+    inline constexpr size_t SHARD_RING_POINTS = 64;
+    // A router asks each shard for a GET this many messages at a time, so
+    // besides the merged result it holds at most one page per shard.
+    inline constexpr size_t SHARD_PAGE_MESSAGES = 1024;
+
+    [[nodiscard]] inline auto shard_of(uintmax_t message_id) -> size_t
+    {
+        return static_cast<size_t>(message_id & (MAX_SHARDS - 1));
+    }
+
+    // Consistent hashing of senders onto shards, so all posts from one
+    // sender land on the same shard.
+    class shard_ring
+    {
+      private:
+        // (hash, shard), sorted by hash.
+        std::vector<std::pair<uint64_t, size_t>> points;
+
+      public:
+        explicit shard_ring(size_t shard_count);
+
+        [[nodiscard]] auto owner(std::string_view key) const -> size_t;
+    };
+
+    // Compares a presented cluster secret in time independent of where it
+    // first differs. An empty expected secret matches nothing.
+    [[nodiscard]] auto cluster_secret_matches(
+        std::string_view presented,
+        std::string_view expected
+    ) -> bool;
+
+    // The text command a router sends to a shard for (a page of) a GET. It
+    // always asks for the shard's board version, which the router sums into
+    // the cluster's version.
+    auto format_shard_get(const message_filter &filter) -> std::string;
+
+    // Incremental k-way merge of per-shard GET or SEARCH replies, each in ID
+    // order. Shards may reply a page at a time: once a full page runs dry,
+    // the shard may have more, so merging waits for its next page. A page
+    // is released as soon as its last line is merged.
+    class shard_merge
+    {
+      private:
+        struct shard_page
+        {
+            std::string      reply;
+            std::string_view rest;
+            std::string_view line;
+            // Last merged ID, where the shard's next page starts.
+            std::optional<uintmax_t> last_id;
+            // The page held as many lines as were asked for.
+            bool full     = false;
+            bool received = false;
+        };
+
+        std::vector<shard_page> pages;
+        // Min-heap of (line_id, shard) for the shards with a line at hand.
+        std::vector<std::pair<uintmax_t, size_t>> heads;
+        // Shards whose full page ran dry; they may hold lower IDs than
+        // every head, so nothing merges until they are refilled.
+        std::vector<size_t> starved;
+        size_t              merged_count;
+        uintmax_t           version_sum;
+        bool                every_board_empty;
+
+        // Moves the shard to its next line and onto the heap, or releases
+        // its page once it runs dry.
+        auto next_line(size_t shard) -> void;
+
+      public:
+        explicit shard_merge(size_t shard_count);
+
+        // Takes a shard's reply to a request for at most `requested` lines
+        // (SIZE_MAX when unpaged). An error reply is handed back as the error.
+        auto add_page(size_t shard, std::string reply, size_t requested)
+            -> std::expected<void, std::string>;
+        // Appends lines in ID order until `limit` have been merged in all.
+        // Returns the shards whose next page is needed to go on; empty once
+        // the merge is complete.
+        auto drain(std::string &out, size_t limit) -> std::vector<size_t>;
+
+        // Where the shard's next page starts, once a page was merged.
+        [[nodiscard]] auto resume_after(size_t shard) const -> std::optional<uintmax_t>;
+        [[nodiscard]] auto matches(void) const -> size_t;
+        // Sum of the shards' "VERSION" lines from their first pages.
+        [[nodiscard]] auto version(void) const -> uintmax_t;
+        // Whether every shard reported an empty board.
+        [[nodiscard]] auto boards_empty(void) const -> bool;
+    };
+
+    struct shard_reply
+    {
+        uint32_t    request_id;
+        std::string text;
+    };
+
+    // Router-side connection to one shard node. Requests are routed binary
+    // frames, matched to replies by request ID, so any number can be in
+    // flight on the one connection.
+    class shard_link
+    {
+      private:
+        remote_address         node;
+        std::string            secret;
+        scoped_file_descriptor socket_fd;
+        std::string            read_buffer;
+        std::string            write_buffer;
+        bool                   connected;
+        // The node acknowledges the BINARY handshake with one text line.
+        bool     awaiting_handshake;
+        uint32_t next_request_id;
+
+        shard_link(remote_address address, std::string cluster_secret);
+
+      public:
+        shard_link(void)                                  = delete;
+        shard_link(const shard_link &)                    = delete;
+        auto operator=(const shard_link &) -> shard_link & = delete;
+        shard_link(shard_link &&other) noexcept;
+        auto operator=(shard_link &&other) noexcept -> shard_link &;
+
+        // address is "host:port"; cluster_secret is presented to the node
+        // on every connect.
+        static auto make(const std::string &address, const std::string &cluster_secret)
+            -> std::expected<shard_link, std::string>;
+
+        // Starts a non-blocking connect; requests queue up until it is done.
+        auto start_connect(void) -> std::expected<void, std::string>;
+        // Called on EPOLLOUT while connecting.
+        auto finish_connect(void) -> std::expected<void, std::string>;
+        auto disconnect(void) -> void;
+
+        // Queues a routed frame; returns its request ID.
+        auto queue_request(std::string_view payload) -> uint32_t;
+        // Sends as much queued output as the socket takes.
+        auto send_pending(void) -> std::expected<void, std::string>;
+        // Reads everything the socket has.
+        auto receive(void) -> std::expected<void, std::string>;
+        // The next complete reply, if one has arrived.
+        auto take_reply(void) -> std::expected<std::optional<shard_reply>, std::string>;
+
+        [[nodiscard]] auto get_fd(void) const -> int;
+        [[nodiscard]] auto is_connected(void) const -> bool;
+        [[nodiscard]] auto get_address(void) const -> std::string;
+    };
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef OREORE_COMPRESSION_HPP
+#define OREORE_COMPRESSION_HPP
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+namespace oreore
+{
+    // Once a connection enables compression, every response is sent as a
+    // frame (integers little-endian):
+    //   uint32_t compressed_length (0: the payload is stored uncompressed)
+    //   uint32_t raw_length
+    //   payload  (zlib stream, or raw_length raw bytes when stored)
+    // A response longer than a frame can describe goes out as consecutive
+    // frames whose payloads join up.
+    inline constexpr size_t COMPRESSED_HEADER_SIZE = 8;
+    inline constexpr size_t MAX_FRAME_RAW_LENGTH   = UINT32_MAX;
+    // Responses shorter than this are not worth a deflate call.
+    inline constexpr size_t COMPRESSION_MIN_SIZE   = 256;
+    inline constexpr int    COMPRESSION_FAST_LEVEL = 1;
+    // Shared GET renders are compressed once, so they can afford more effort.
+    inline constexpr int    COMPRESSION_CACHED_LEVEL = 6;
+
+    enum class compression_mode : uint8_t
+    {
+        none,
+        deflate,
+    };
+
+    // False when the server was built without zlib.
+    auto compression_available(void) -> bool;
+    // One frame, or several for a response over MAX_FRAME_RAW_LENGTH.
+    auto make_compressed_frame(std::string_view data, int level) -> std::string;
+
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef OREORE_HOT_RESTART_HPP
+#define OREORE_HOT_RESTART_HPP
+
+#include <oreore/client_connection.hpp>
+#include <oreore/scoped_file_descriptor.hpp>
+
+#include <chrono>
+#include <deque>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace oreore
+{
+    // Handoff protocol over an AF_UNIX SOCK_SEQPACKET socket:
+    //   new -> old : "TAKEOVER" or "TAKEOVER CLIENTS"
+    //   old -> new : header { u32 magic, u32 fd_count, u64 state_length }
+    //                with the state file, then the listening sockets,
+    //                attached (SCM_RIGHTS)
+    //   old -> new : one-byte messages carrying the client sockets, in
+    //                groups of up to HANDOFF_FDS_PER_MESSAGE
+    //   new -> old : "READY" once it is serving the listeners
+    //   old -> new : "RELEASED", after which the old process drains
+    // Until READY the old process keeps everything, so a replacement that
+    // fails to start costs nothing but the pause.
+    // The state file is a memfd of state_length bytes: the listener count,
+    // the length of the store, the store as replication events, then each
+    // client's buffers, in fd order. Only descriptors cross the socket, so
+    // the old process never waits for the new one to read the store.
+    // The old process runs its side from the event loop, so a slow peer
+    // only holds up the takeover.
+    inline constexpr uint32_t HANDOFF_MAGIC           = 0x5248524F; // "ORHR"
+    inline constexpr size_t   HANDOFF_FDS_PER_MESSAGE = 64;
+    // Bytes gathered before each write to the state file.
+    inline constexpr size_t   HANDOFF_CHUNK_SIZE      = 64 * 1024;
+    // How long the peer has to send its request, and then how long it may
+    // take to report READY before the old process carries on.
+    inline constexpr int      HANDOFF_TIMEOUT_SECONDS = 5;
+    inline constexpr int      HANDOFF_TRANSFER_TIMEOUT_SECONDS = 30;
+    inline constexpr int      DRAIN_TIMEOUT_SECONDS   = 30;
+    inline constexpr int      DRAIN_POLL_INTERVAL_MS  = 100;
+    inline constexpr const char TAKEOVER_REQUEST[]    = "TAKEOVER";
+    inline constexpr const char TAKEOVER_CLIENTS_REQUEST[] = "TAKEOVER CLIENTS";
+    inline constexpr const char TAKEOVER_READY[]           = "READY";
+    inline constexpr const char TAKEOVER_RELEASED[]        = "RELEASED";
+
+    struct handoff_state
+    {
+        // The connection to the old process, for confirm_takeover().
+        scoped_file_descriptor              peer;
+        std::vector<scoped_file_descriptor> listeners;
+        std::string                         store_snapshot;
+        std::vector<client_connection>      clients;
+    };
+
+    // Old process: builds the state file. The store goes in first, in
+    // pieces, then the clients; finish() fills in the store's length.
+    class handoff_state_file
+    {
+      private:
+        scoped_file_descriptor fd;
+        // Bytes not yet written to fd, and the count of those that were.
+        std::string pending;
+        uint64_t    written;
+        uint64_t    store_length;
+
+        handoff_state_file(scoped_file_descriptor &&file, size_t listener_count);
+
+        auto flush(bool force) -> std::expected<void, std::string>;
+
+      public:
+        static auto make(size_t listener_count)
+            -> std::expected<handoff_state_file, std::string>;
+
+        auto append_store(std::string_view events) -> std::expected<void, std::string>;
+        auto append_client(client_connection &client)
+            -> std::expected<void, std::string>;
+        auto finish(void) -> std::expected<void, std::string>;
+
+        [[nodiscard]] auto get_fd(void) const -> int;
+        [[nodiscard]] auto size(void) const -> uint64_t;
+    };
+
+    enum class handoff_phase
+    {
+        request,   // waiting for the peer's request
+        quiescing, // waiting for in-flight work to finish
+        sending,   // handoff messages queued for the peer
+        awaiting_ready,
+        released,  // the peer is serving; drain
+    };
+
+    // Old process: one replacement's takeover, on a non-blocking socket
+    // driven by the event loop.
+    class handoff_peer
+    {
+      private:
+        struct outgoing_message
+        {
+            std::string      data;
+            std::vector<int> fds;
+        };
+
+        scoped_file_descriptor                fd;
+        handoff_phase                         phase;
+        bool                                  with_clients;
+        std::chrono::steady_clock::time_point deadline;
+        // Kept open until the message carrying it is sent.
+        std::optional<handoff_state_file> state;
+        std::deque<outgoing_message>      outbox;
+
+      public:
+        // Takes a freshly accepted, non-blocking peer.
+        explicit handoff_peer(scoped_file_descriptor &&peer);
+
+        // True once the request has arrived; the phase is then quiescing.
+        auto receive_request(void) -> std::expected<bool, std::string>;
+        // Queues the listeners, the finished state file and the clients
+        // written to it, and starts sending. The descriptors stay owned by
+        // the caller and must stay open until the phase reaches released.
+        auto start_sending(
+            std::span<const scoped_file_descriptor> listeners,
+            handoff_state_file                    &&state_file,
+            std::span<client_connection *const>     clients
+        ) -> void;
+        // Sends what the socket takes; the phase moves on to awaiting_ready
+        // once all went out.
+        auto send_pending(void) -> std::expected<void, std::string>;
+        // True once the peer reported READY and was told RELEASED.
+        auto receive_ready(void) -> std::expected<bool, std::string>;
+
+        [[nodiscard]] auto get_fd(void) const -> int;
+        [[nodiscard]] auto get_phase(void) const -> handoff_phase;
+        [[nodiscard]] auto wants_clients(void) const -> bool;
+        [[nodiscard]] auto has_expired(std::chrono::steady_clock::time_point now) const
+            -> bool;
+    };
+
+    // Binds a non-blocking SOCK_SEQPACKET listener at path, replacing any
+    // stale socket file left there.
+    auto make_handoff_listener(const std::string &path)
+        -> std::expected<scoped_file_descriptor, std::string>;
+
+    // New process: connects to the old process at path and takes over.
+    auto receive_handoff(const std::string &path, bool with_clients)
+        -> std::expected<handoff_state, std::string>;
+
+    // New process: once it serves the listeners, tells the old process to
+    // drain. An error means the old process gave up and kept serving.
+    auto confirm_takeover(int peer_fd) -> std::expected<void, std::string>;
+
+}
+
+#endif
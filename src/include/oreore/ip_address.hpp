@@ -12,11 +12,13 @@
 namespace oreore
 {
 
+    // Built from the raw value on every accept, so the dotted-quad text is
+    // only formatted the first time someone asks for it.
     class ip_address
     {
       private:
-        std::optional<std::string> optional_address_string;
-        std::optional<uint32_t>    optional_address_raw;
+        mutable std::optional<std::string> optional_address_string;
+        std::optional<uint32_t>            optional_address_raw;
 
         ip_address(const std::string &addr_str);
         ip_address(uint32_t addr_raw);
@@ -0,0 +1,53 @@
+#ifndef OREORE_LISTEN_ENDPOINT_HPP
+#define OREORE_LISTEN_ENDPOINT_HPP
+
+#include <oreore/scoped_file_descriptor.hpp>
+#include <oreore/socket_tuning.hpp>
+
+#include <expected>
+#include <stdint.h>
+#include <string>
+
+namespace oreore
+{
+    enum class endpoint_kind : uint8_t
+    {
+        tcp,           // tcp:<port> (or a bare port number)
+        unix_path,     // unix:<path>
+        unix_abstract, // unix:@<name>, Linux abstract namespace
+    };
+
+    struct listen_endpoint
+    {
+        endpoint_kind kind = endpoint_kind::tcp;
+        uint16_t      port = 0;
+        // Socket path, or the abstract name without its leading '@'.
+        std::string path;
+    };
+
+    auto parse_listen_endpoint(const std::string &specification)
+        -> std::expected<listen_endpoint, std::string>;
+    [[nodiscard]] auto describe_listen_endpoint(const listen_endpoint &endpoint)
+        -> std::string;
+
+    // Opens a non-blocking listener for any endpoint kind. Path sockets
+    // replace a stale socket file left at the same path. reuse_port lets
+    // several processes bind the same TCP port (SO_REUSEPORT), with the
+    // kernel spreading new connections across them. TCP listeners get the
+    // profile's tune_listener options before they start listening.
+    auto make_listening_socket(
+        const listen_endpoint &endpoint,
+        int                    backlog,
+        bool                   reuse_port,
+        latency_profile        profile
+    ) -> std::expected<scoped_file_descriptor, std::string>;
+    auto make_listening_socket(
+        uint16_t        port,
+        int             backlog,
+        bool            reuse_port,
+        latency_profile profile
+    ) -> std::expected<scoped_file_descriptor, std::string>;
+
+}
+
+#endif
@@ -1,25 +1,53 @@
 #ifndef OREORE_MESSAGE_HPP
 #define OREORE_MESSAGE_HPP
 
+#include <atomic>
+#include <optional>
 #include <stdint.h>
 #include <string>
+#include <string_view>
 
 namespace oreore
 {
     inline constexpr int BACKLOG_SIZE     = 128; // listen backlog often int
     inline constexpr int MAX_EPOLL_EVENTS = 64;  // Max events for epoll_wait
     inline constexpr size_t BUFFER_SIZE = 4096; // For individual read operations
+    inline constexpr size_t MAX_BATCH_SIZE = 4096; // Max lines in MPOST/BATCH
 
+    enum class reaction_kind : uint8_t
+    {
+        none,
+        happy,
+        sad,
+    };
+
+    // "HAPPY", "SAD", or "" for none.
+    auto reaction_name(reaction_kind kind) -> std::string_view;
+    auto parse_reaction(std::string_view name) -> reaction_kind;
+
+    // Boards store messages in place, so a message is neither copied nor
+    // moved. The reaction state is atomic because snapshot readers on render
+    // workers read it while the event loop applies new reactions.
     struct message
     {
-        uintmax_t   id;
-        std::string text;
-        std::string sender_ip;
-        std::string reaction;
+        uintmax_t                  id = 0;
+        std::string                text;
+        std::string                sender_ip;
+        // Last reaction received.
+        std::atomic<reaction_kind> reaction { reaction_kind::none };
+        // Totals, bumped under the store lock; readers load them relaxed.
+        std::atomic<uint64_t> happy_count { 0 };
+        std::atomic<uint64_t> sad_count { 0 };
+
+        message(void) = default;
+        message(const message &)                     = delete;
+        auto operator=(const message &) -> message & = delete;
     };
 
     auto make_errno_message(const std::string &base_message) -> std::string;
     auto trim(const std::string &str) -> std::string;
+    // Parses the whole of str as a decimal unsigned integer.
+    auto parse_unsigned(std::string_view str) -> std::optional<uintmax_t>;
 
 }
 
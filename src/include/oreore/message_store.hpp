@@ -0,0 +1,175 @@
+#ifndef OREORE_MESSAGE_STORE_HPP
+#define OREORE_MESSAGE_STORE_HPP
+
+#include <oreore/message.hpp>
+#include <oreore/replication.hpp>
+
+#include <array>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace oreore
+{
+
+    inline constexpr size_t DEFAULT_SEARCH_LIMIT = 100;
+    inline constexpr size_t MAX_SEARCH_LIMIT     = 10000;
+    inline constexpr size_t MESSAGE_SEGMENT_SIZE = 4096;
+
+    inline constexpr std::string_view EMPTY_BOARD_REPLY = "Stack is empty.\n";
+    inline constexpr std::string_view NO_MATCH_REPLY    = "No messages match.\n";
+
+    // Selects the messages a GET renders. Unset members do not filter.
+    // `reaction` uses "" for messages nobody has reacted to (REACTION NONE).
+    struct message_filter
+    {
+        std::optional<std::string> sender_ip;
+        std::optional<std::string> reaction;
+        std::optional<uintmax_t>   after_id;
+        size_t                     limit = SIZE_MAX;
+        // Conditional GET: when the board is still at this version the
+        // reply is a single "NOT MODIFIED" line, otherwise the result is
+        // followed by a "VERSION" line.
+        std::optional<uintmax_t> if_changed_since;
+    };
+
+    // Messages live in fixed-size segments that never move once allocated,
+    // so a snapshot can keep reading a prefix of the board while the store
+    // appends past it.
+    struct message_segment
+    {
+        std::array<message, MESSAGE_SEGMENT_SIZE> slots;
+    };
+    using segment_list = std::vector<std::shared_ptr<message_segment>>;
+
+    // The result set of a GET, pinned when it was taken. Rendering needs no
+    // lock and may run on any thread; only reactions can move on meanwhile.
+    class message_snapshot
+    {
+      private:
+        friend class message_store;
+
+        segment_list segments;
+        // Either the contiguous positions [first, last) or, for filtered
+        // reads, an explicit list.
+        size_t              first;
+        size_t              last;
+        std::vector<size_t> positions;
+        bool                use_positions;
+        std::string_view    empty_reply;
+        // Board version, reported after the result of a conditional GET.
+        std::optional<uintmax_t> version;
+        bool                     not_modified;
+
+        auto append_version(std::string &rendered) const -> void;
+
+      public:
+        message_snapshot(void);
+
+        [[nodiscard]] auto size(void) const -> size_t;
+        [[nodiscard]] auto render(void) const -> std::string;
+    };
+
+    // Append-only message board. Every accessor except lock() expects the
+    // caller to hold the lock returned by lock(), so that a batch of commands
+    // can be applied under a single acquisition.
+    class message_store
+    {
+      private:
+        segment_list messages;
+        size_t       message_count;
+        std::mutex   messages_mutex;
+        uintmax_t    next_message_id;
+        // Distance between consecutive IDs: 1, or MAX_SHARDS on a shard
+        // node, whose IDs all end in its shard index.
+        uintmax_t id_stride;
+
+        // Trigram -> positions in messages (ascending) of every message whose
+        // text contains it. Positions are stable because the board only
+        // appends.
+        std::unordered_map<uint32_t, std::vector<size_t>> trigram_index;
+        // Secondary indexes for filtered GET, also keyed by position.
+        std::unordered_map<std::string, std::vector<size_t>> sender_index;
+        std::array<std::set<size_t>, 3>                      reaction_index;
+
+        // Ordered log of every mutation, streamed to read replicas. The
+        // index into the log is the replication sequence number.
+        struct logged_event
+        {
+            replication_event_kind kind;
+            size_t                 position;
+        };
+        std::vector<logged_event> event_log;
+
+        auto               at(size_t position) -> message &;
+        [[nodiscard]] auto at(size_t position) const -> const message &;
+        [[nodiscard]] auto find(uintmax_t message_id) const -> std::optional<size_t>;
+        auto append(uintmax_t id, std::string text, const std::string &sender_ip)
+            -> void;
+        auto index_text(size_t position) -> void;
+        [[nodiscard]] auto first_position_after(std::optional<uintmax_t> after_id
+        ) const -> size_t;
+
+      public:
+        message_store(void);
+        // A shard node's board; see cluster.hpp for the ID layout.
+        explicit message_store(size_t shard_index);
+        message_store(const message_store &)                     = delete;
+        auto operator=(const message_store &) -> message_store & = delete;
+
+        message_store(message_store &&other) noexcept;
+        auto operator=(message_store &&other) noexcept -> message_store &;
+
+        [[nodiscard]] auto lock(void) -> std::unique_lock<std::mutex>;
+
+        auto post(std::string text, const std::string &sender_ip) -> uintmax_t;
+        // Allocates consecutive IDs; returns the first one.
+        auto post_batch(
+            std::span<const std::string> texts,
+            const std::string           &sender_ip
+        ) -> uintmax_t;
+        auto react(uintmax_t message_id, const std::string &reaction)
+            -> std::expected<void, std::string>;
+        // Also the board version: it moves on with every post and reaction,
+        // and a follower reports the same version as its primary.
+        [[nodiscard]] auto event_count(void) const -> uintmax_t;
+        [[nodiscard]] auto get_id_stride(void) const -> uintmax_t;
+        // Appends events from `from_sequence` on to `out` until roughly
+        // max_bytes have been written; returns the next sequence to send.
+        auto format_events(uintmax_t from_sequence, size_t max_bytes, std::string &out)
+            const -> uintmax_t;
+        // Calls visit(kind, position, message) for each event from
+        // `from_sequence` on, passing the message as it is now; returns the
+        // next sequence.
+        template <typename Visitor>
+        auto visit_events(uintmax_t from_sequence, Visitor &&visit) const -> uintmax_t
+        {
+            for (; from_sequence < event_log.size(); ++from_sequence)
+            {
+                const logged_event &event = event_log[from_sequence];
+                visit(event.kind, event.position, at(event.position));
+            }
+            return from_sequence;
+        }
+        // Applies an event received from the primary. Events already applied
+        // are ignored so a follower can safely re-subscribe.
+        auto apply(const replication_event &event) -> std::expected<void, std::string>;
+
+        [[nodiscard]] auto snapshot(const message_filter &filter) const
+            -> message_snapshot;
+        [[nodiscard]] auto render(const message_filter &filter) const
+            -> std::string;
+        [[nodiscard]] auto search(std::string_view term, size_t limit) const
+            -> std::string;
+    };
+
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef OREORE_MESSAGE_TEXT_HPP
+#define OREORE_MESSAGE_TEXT_HPP
+
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace oreore
+{
+    inline constexpr size_t DEFAULT_MAX_MESSAGE_LENGTH = 64 * 1024;
+
+    // Checks a message body and escapes it for the `Msg: "..."` field.
+    // Control bytes other than tab and malformed UTF-8 are rejected; '"'
+    // and '\' are escaped with a backslash. `max_length` limits the body as received.
+    auto normalize_message_text(std::string_view text, size_t max_length)
+        -> std::expected<std::string, std::string>;
+
+    // Scanner chosen for this CPU: "avx2", "sse4.1" or "scalar".
+    auto message_text_scanner(void) -> std::string_view;
+
+}
+
+#endif
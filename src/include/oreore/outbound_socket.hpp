@@ -0,0 +1,33 @@
+#ifndef OREORE_OUTBOUND_SOCKET_HPP
+#define OREORE_OUTBOUND_SOCKET_HPP
+
+#include <oreore/scoped_file_descriptor.hpp>
+
+#include <expected>
+#include <stdint.h>
+#include <string>
+
+namespace oreore
+{
+    // A peer this server connects to (a primary, or a shard node).
+    struct remote_address
+    {
+        std::string host;
+        uint16_t    port = 0;
+    };
+
+    // address is "host:port".
+    auto parse_remote_address(const std::string &address)
+        -> std::expected<remote_address, std::string>;
+    [[nodiscard]] auto describe_remote_address(const remote_address &address)
+        -> std::string;
+
+    // Starts a non-blocking TCP connect; completion is signalled by EPOLLOUT.
+    auto start_outbound_connect(const remote_address &address)
+        -> std::expected<scoped_file_descriptor, std::string>;
+    // Called on EPOLLOUT: reports whether the connect succeeded.
+    auto check_outbound_connect(int socket_fd) -> std::expected<void, std::string>;
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef OREORE_OVERLOAD_CONTROLLER_HPP
+#define OREORE_OVERLOAD_CONTROLLER_HPP
+
+#include <chrono>
+#include <stdint.h>
+#include <string_view>
+
+namespace oreore
+{
+    inline constexpr auto   DEFAULT_OVERLOAD_LAG_LIMIT    = std::chrono::milliseconds(50);
+    inline constexpr size_t DEFAULT_OVERLOAD_BUFFER_LIMIT = 512 * 1024 * 1024;
+    // How often the level is re-evaluated, and how often an overloaded
+    // loop wakes up to do so while idle.
+    inline constexpr auto OVERLOAD_SAMPLE_INTERVAL = std::chrono::milliseconds(10);
+    inline constexpr int  OVERLOAD_RECHECK_MS      = 10;
+    // Answer to commands refused while shedding.
+    inline constexpr std::string_view OVERLOAD_REPLY = "ERR: busy\n";
+
+    enum class overload_level : uint8_t
+    {
+        normal,
+        throttled, // accepts paused
+        shedding,  // accepts paused and new commands refused
+    };
+
+    auto overload_level_name(overload_level level) -> std::string_view;
+
+    // Commands are refused at a limit; accepts pause at half of it. Zero
+    // disables a limit.
+    struct overload_limits
+    {
+        // Smoothed time the loop takes to handle one batch of events.
+        std::chrono::microseconds lag_limit = DEFAULT_OVERLOAD_LAG_LIMIT;
+        // Bytes waiting in connection read and write buffers.
+        size_t buffered_limit = DEFAULT_OVERLOAD_BUFFER_LIMIT;
+    };
+
+    // Turns event-loop lag and buffered bytes into an overload level. Each
+    // level is left at a lower pressure than it is entered at, so the
+    // server does not flap around a threshold.
+    class overload_controller
+    {
+      public:
+        using clock = std::chrono::steady_clock;
+
+      private:
+        overload_limits           limits;
+        overload_level            level;
+        std::chrono::microseconds smoothed_lag;
+        size_t                    buffered_bytes;
+        clock::time_point         next_sample;
+
+      public:
+        explicit overload_controller(const overload_limits &configured);
+
+        // Folds in how long the loop took over its latest batch of events.
+        auto record_loop_lag(clock::duration lag) -> void;
+        // Whether the level is due to be re-evaluated.
+        [[nodiscard]] auto sample_due(clock::time_point now) const -> bool;
+        // Re-evaluates the level with a fresh buffered-bytes reading.
+        auto update(size_t buffered, clock::time_point now) -> overload_level;
+
+        [[nodiscard]] auto get_level(void) const -> overload_level;
+        [[nodiscard]] auto get_smoothed_lag(void) const -> std::chrono::microseconds;
+        [[nodiscard]] auto get_buffered_bytes(void) const -> size_t;
+    };
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef OREORE_PEER_ADDRESS_HPP
+#define OREORE_PEER_ADDRESS_HPP
+
+#include <oreore/ip_address.hpp>
+
+#include <expected>
+#include <string>
+#include <sys/types.h>
+#include <variant>
+
+namespace oreore
+{
+    inline constexpr const char LOCAL_PEER_PREFIX[] = "unix:";
+
+    // Identity of the other end of a connection: an IPv4 address for TCP
+    // peers, or "unix:pid=<pid>,uid=<uid>" for local (AF_UNIX) peers.
+    class peer_address
+    {
+      private:
+        std::variant<ip_address, std::string> identity;
+
+        explicit peer_address(ip_address &&address);
+        explicit peer_address(std::string &&local_identity);
+
+      public:
+        peer_address(void)                                     = delete;
+        peer_address(const peer_address &)                     = default;
+        auto operator=(const peer_address &) -> peer_address & = default;
+        peer_address(peer_address &&other) noexcept            = default;
+        auto operator=(peer_address &&other) noexcept -> peer_address & = default;
+
+        static auto make(ip_address &&address)
+            -> std::expected<peer_address, std::string>;
+        static auto make_local(pid_t pid, uid_t uid)
+            -> std::expected<peer_address, std::string>;
+        // Inverse of get_string(), for identities carried across processes.
+        static auto parse(const std::string &peer_string)
+            -> std::expected<peer_address, std::string>;
+
+        [[nodiscard]] auto is_local(void) const -> bool;
+        [[nodiscard]] auto get_string(void) const -> std::string;
+    };
+
+}
+
+#endif
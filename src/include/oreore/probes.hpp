@@ -0,0 +1,32 @@
+#ifndef OREORE_PROBES_HPP
+#define OREORE_PROBES_HPP
+
+// Static USDT tracepoints under the "oreore" provider, for bpftrace, perf
+// and SystemTap (e.g. `bpftrace -l 'usdt:./protocol-from-scratch:oreore:*'`).
+// A disabled probe is a single nop in the instruction stream. Without
+// <sys/sdt.h> the macros expand to nothing.
+//
+//   accept          (int fd)
+//   read            (int fd, ssize_t bytes)
+//   command__start  (int fd, const char *command_line)
+//   command__end    (int fd)
+//   frame__start    (int fd, uint8_t opcode, uint32_t request_id)
+//   frame__end      (int fd, uint32_t request_id)
+//   lock__acquire   ()          store lock requested
+//   lock__acquired  ()          store lock held
+//   queue           (int fd, size_t bytes)
+//   flush           (int fd, ssize_t bytes)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define OREORE_PROBE0(name)          DTRACE_PROBE(oreore, name)
+#define OREORE_PROBE1(name, a)       DTRACE_PROBE1(oreore, name, a)
+#define OREORE_PROBE2(name, a, b)    DTRACE_PROBE2(oreore, name, a, b)
+#define OREORE_PROBE3(name, a, b, c) DTRACE_PROBE3(oreore, name, a, b, c)
+#else
+#define OREORE_PROBE0(name)          static_cast<void>(0)
+#define OREORE_PROBE1(name, a)       static_cast<void>(0)
+#define OREORE_PROBE2(name, a, b)    static_cast<void>(0)
+#define OREORE_PROBE3(name, a, b, c) static_cast<void>(0)
+#endif
+
+#endif
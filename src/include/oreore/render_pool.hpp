@@ -0,0 +1,89 @@
+#ifndef OREORE_RENDER_POOL_HPP
+#define OREORE_RENDER_POOL_HPP
+
+#include <oreore/compression.hpp>
+#include <oreore/message_store.hpp>
+#include <oreore/scoped_file_descriptor.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oreore
+{
+    inline constexpr size_t DEFAULT_RENDER_WORKERS = 2;
+    inline constexpr size_t MAX_RENDER_WORKERS     = 64;
+    inline constexpr size_t RENDER_QUEUE_LIMIT     = 1024;
+    // Smaller results render inline: a hand-off would cost more than it saves.
+    inline constexpr size_t OFFLOAD_MIN_MESSAGES = 2048;
+
+    struct render_job
+    {
+        int              client_fd;
+        uint64_t         ticket;
+        message_snapshot snapshot;
+        // Set for compressed GETs: the render comes back as a compression
+        // frame deflated at this level.
+        std::optional<int> compression_level;
+    };
+
+    // Renders the job's snapshot, deflated when the job asks for it.
+    auto run_render_job(const render_job &job) -> std::string;
+
+    struct render_result
+    {
+        int         client_fd;
+        uint64_t    ticket;
+        std::string rendered;
+    };
+
+    // Fixed set of threads that render GET snapshots off the event loop.
+    // Finished renders queue up for the loop, which is woken through an
+    // eventfd it watches with epoll.
+    class render_pool
+    {
+      private:
+        std::mutex                 jobs_mutex;
+        std::condition_variable    jobs_ready;
+        std::condition_variable    jobs_done;
+        std::deque<render_job>     jobs;
+        size_t                     busy_workers;
+        bool                       stopping;
+        std::mutex                 results_mutex;
+        std::vector<render_result> results;
+        scoped_file_descriptor     completion_fd;
+        std::vector<std::thread>   workers;
+
+        explicit render_pool(scoped_file_descriptor &&event_fd);
+
+        auto worker_main(void) -> void;
+
+      public:
+        render_pool(const render_pool &)                     = delete;
+        auto operator=(const render_pool &) -> render_pool & = delete;
+
+        ~render_pool(void);
+
+        static auto make(size_t worker_count)
+            -> std::expected<std::unique_ptr<render_pool>, std::string>;
+
+        [[nodiscard]] auto get_completion_fd(void) const -> int;
+        // Takes the job unless the queue is full, in which case it is left
+        // untouched for the caller to render itself.
+        auto try_submit(render_job &job) -> bool;
+        // Finished renders, in completion order.
+        auto take_results(void) -> std::vector<render_result>;
+        // Blocks until every submitted job has finished.
+        auto wait_idle(void) -> void;
+    };
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef OREORE_REPLICATION_HPP
+#define OREORE_REPLICATION_HPP
+
+#include <oreore/outbound_socket.hpp>
+#include <oreore/scoped_file_descriptor.hpp>
+
+#include <expected>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+namespace oreore
+{
+    // Wire format, one event per line, primary -> follower:
+    //   EV <sequence> POST <id> <sender> <text>
+    //   EV <sequence> HAPPY <id>
+    //   EV <sequence> SAD <id>
+    // A follower subscribes with "REPLICATE <next sequence>\n" and receives
+    // every event from that sequence on, then live events as they happen.
+    inline constexpr const char REPLICATE_COMMAND[]    = "REPLICATE";
+    inline constexpr size_t     REPLICA_CHUNK_BYTES    = 256 * 1024;
+    inline constexpr int        REPLICA_RETRY_SECONDS  = 1;
+
+    enum class replication_event_kind : uint8_t
+    {
+        post,
+        happy,
+        sad,
+    };
+
+    struct replication_event
+    {
+        uintmax_t              sequence;
+        replication_event_kind kind;
+        uintmax_t              message_id;
+        std::string            sender_ip;
+        std::string            text;
+    };
+
+    auto format_replication_event(
+        uintmax_t              sequence,
+        replication_event_kind kind,
+        uintmax_t              message_id,
+        std::string_view       sender_ip,
+        std::string_view       text
+    ) -> std::string;
+    auto parse_replication_event(std::string_view line)
+        -> std::expected<replication_event, std::string>;
+
+    // Follower-side connection to the primary. Connects without blocking and
+    // is re-created by the server whenever the primary goes away.
+    class replication_link
+    {
+      private:
+        remote_address         primary;
+        scoped_file_descriptor socket_fd;
+        std::string            read_buffer;
+        bool                   connected;
+
+        explicit replication_link(remote_address address);
+
+      public:
+        replication_link(void)                                   = delete;
+        replication_link(const replication_link &)               = delete;
+        auto operator=(const replication_link &) -> replication_link & = delete;
+        replication_link(replication_link &&other) noexcept;
+        auto operator=(replication_link &&other) noexcept -> replication_link &;
+
+        // address is "host:port".
+        static auto make(const std::string &address)
+            -> std::expected<replication_link, std::string>;
+
+        // Starts a non-blocking connect; completion is signalled by EPOLLOUT.
+        auto start_connect(void) -> std::expected<void, std::string>;
+        // Called on EPOLLOUT: checks the connect result and subscribes.
+        auto finish_connect(uintmax_t next_sequence)
+            -> std::expected<void, std::string>;
+        auto disconnect(void) -> void;
+
+        [[nodiscard]] auto get_fd(void) const -> int;
+        [[nodiscard]] auto is_connected(void) const -> bool;
+        [[nodiscard]] auto get_address(void) const -> std::string;
+        auto               get_read_buffer(void) -> std::string &;
+    };
+
+}
+
+#endif
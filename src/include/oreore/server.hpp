@@ -1,30 +1,191 @@
 #ifndef OREORE_SERVER_HPP
 #define OREORE_SERVER_HPP
 
+#include <oreore/binary_protocol.hpp>
 #include <oreore/client_connection.hpp>
+#include <oreore/cluster.hpp>
+#include <oreore/hot_restart.hpp>
+#include <oreore/listen_endpoint.hpp>
 #include <oreore/message.hpp>
+#include <oreore/message_store.hpp>
+#include <oreore/message_text.hpp>
+#include <oreore/overload_controller.hpp>
+#include <oreore/probes.hpp>
+#include <oreore/render_pool.hpp>
+#include <oreore/replication.hpp>
 #include <oreore/scoped_file_descriptor.hpp>
+#include <oreore/shared_board.hpp>
+#include <oreore/socket_tuning.hpp>
+#include <oreore/task.hpp>
+#include <oreore/trace_recorder.hpp>
+#include <oreore/traffic_recorder.hpp>
 
+#include <chrono>
+#include <coroutine>
+#include <deque>
 #include <expected>
+#include <iosfwd>
 #include <map>
-#include <mutex>
+#include <memory>
+#include <optional>
+#include <set>
+#include <span>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace oreore
 {
+    // A connection with this much unsent output stops reading commands
+    // until the peer catches up.
+    inline constexpr size_t CONNECTION_OUTPUT_HIGH_WATER = 4 * 1024 * 1024;
+
+    struct server_options
+    {
+        // Every endpoint feeds the same event loop.
+        std::vector<listen_endpoint> listen_endpoints;
+        int                          backlog = BACKLOG_SIZE;
+        // "host:port" of a primary. When set, the server runs as a read-only
+        // follower that replicates the primary's board.
+        std::optional<std::string> primary_address;
+        // Unix socket on which a replacement process can take over.
+        std::optional<std::string> handoff_socket_path;
+        // Take over the listener (and optionally the live connections) of
+        // the process serving handoff requests at this path.
+        std::optional<std::string> takeover_socket_path;
+        bool                       takeover_clients = false;
+        // Back pooled buffers with huge pages where available.
+        bool huge_pages = false;
+        // Socket options for TCP listeners and connections.
+        latency_profile latency = latency_profile::standard;
+        // How listeners shared with other processes hand out connections.
+        listener_distribution distribution = listener_distribution::shared;
+        // Log every accept, close and command along with its peer.
+        bool log_connections = true;
+        // After handling events, poll epoll without sleeping for up to this
+        // long before blocking again. Zero always blocks.
+        std::chrono::microseconds busy_spin { 0 };
+        // Threads rendering large GETs off the event loop; 0 renders inline.
+        size_t render_workers = DEFAULT_RENDER_WORKERS;
+        // Longest message body accepted from a client, in bytes.
+        size_t max_message_length = DEFAULT_MAX_MESSAGE_LENGTH;
+        // Chrome-trace file for sampled request phases; off when unset.
+        std::optional<std::string> trace_path;
+        uint32_t                   trace_sample_every = DEFAULT_TRACE_SAMPLE_EVERY;
+        // File receiving every client command for later replay; off when
+        // unset.
+        std::optional<std::string> record_path;
+        // POSIX shared memory name (e.g. "/oreore-board") under which the
+        // board is mirrored for local readers; off when unset.
+        std::optional<std::string> shared_board_name;
+        size_t                     shared_board_capacity = DEFAULT_SHARED_BOARD_CAPACITY;
+        // Accepts pause while this many clients are connected; 0 means no
+        // limit.
+        size_t max_connections = 0;
+        // When to pause accepts and refuse commands under load.
+        overload_limits overload;
+        // Cluster mode. A shard node owns the message IDs ending in its
+        // index; a router holds no board and forwards every command to the
+        // shard nodes listed here, in shard index order.
+        std::optional<size_t>    shard_index;
+        std::vector<std::string> shard_addresses;
+        // Required of routers and shard nodes: a shard node takes routed
+        // commands only from connections that presented it.
+        std::string cluster_secret;
+    };
 
     class server
     {
       private:
         scoped_file_descriptor epoll_file_descriptor;
-        scoped_file_descriptor server_file_descriptor;
+        std::vector<scoped_file_descriptor> listener_fds;
+        server_options                      options;
+
+        message_store                    store;
+        // Connection nodes come from the per-thread pool, so accept/close
+        // churn recycles warm slots instead of hitting malloc.
+        using client_map = std::map<
+            int,
+            client_connection,
+            std::less<int>,
+            pool_allocator<std::pair<const int, client_connection>>>;
+        client_map client_connections;
+        // Closed connections whose coroutine may still be on the stack. Their
+        // map nodes are kept alive until the current event batch is done.
+        std::vector<client_map::node_type> closed_clients;
+        // Connection whose coroutine is executing, or -1.
+        int running_connection_fd;
+
+        // Compressed full GET, shared by every compressing client until the
+        // board version (its event count) moves on.
+        struct compressed_render
+        {
+            std::optional<uintmax_t> version;
+            std::string              frame;
+        };
+        compressed_render compressed_get_cache;
+
+        // Follower side: link to the primary and its reconnect timer.
+        std::optional<replication_link> primary_link;
+        scoped_file_descriptor          replication_timer_fd;
+        // Primary side: connections that subscribed with REPLICATE.
+        std::set<int> replica_subscribers;
+
+        // Router side: a link per shard node, where each sender's posts go,
+        // and requests awaiting a reply keyed by (shard << 32 | request ID).
+        // Calls with every reply in are resumed from the loop, never from
+        // inside another connection's coroutine.
+        struct shard_call;
+        std::vector<shard_link>                                         shard_links;
+        std::optional<shard_ring>                                       placement;
+        std::unordered_map<uint64_t, std::pair<shard_call *, size_t>> shard_waiters;
+        std::deque<shard_call *>                                        ready_shard_calls;
+
+        // Event loop counters, reported by STATS.
+        struct loop_counters
+        {
+            uintmax_t busy_polls     = 0; // non-blocking polls that found nothing
+            uintmax_t blocking_waits = 0;
+            uintmax_t offloaded_renders = 0;
+            uintmax_t shed_commands     = 0; // answered "ERR: busy"
+            uintmax_t accept_pauses     = 0;
+        };
+        loop_counters loop_stats;
+
+        // Overload protection: listeners leave epoll while accepts are
+        // paused.
+        overload_controller overload;
+        bool                accepting;
+        // Bytes in every connection's read and write buffers, kept in step
+        // as they fill and drain so sampling it costs nothing.
+        size_t buffered_bytes;
 
-        std::vector<message>             messages;
-        std::mutex                       messages_mutex;
-        uintmax_t                        next_message_id;
-        std::map<int, client_connection> client_connections;
+        // Large GETs render on these workers from a pinned store snapshot.
+        struct render_awaiter;
+        std::unique_ptr<render_pool>                    renderer;
+        uint64_t                                        next_render_ticket;
+        std::unordered_map<uint64_t, render_awaiter *> render_waiters;
 
-        server(scoped_file_descriptor &&epoll_fd, scoped_file_descriptor &&server_fd);
+        // Present when --trace-file is given.
+        std::unique_ptr<trace_recorder> tracer;
+        // Present when --record is given.
+        std::unique_ptr<traffic_recorder> recorder;
+        // Present when --shm-board is given.
+        std::optional<shared_board> board_mirror;
+
+        // Hot restart: the old process hands over and then drains. Once a
+        // replacement has asked to take over, reads and accepts pause so the
+        // state it receives stays current.
+        scoped_file_descriptor                handoff_listener_fd;
+        std::optional<handoff_peer>           takeover;
+        bool                                  draining;
+        std::chrono::steady_clock::time_point drain_deadline;
+
+        server(
+            scoped_file_descriptor &&epoll_fd,
+            std::vector<scoped_file_descriptor> &&listeners,
+            const server_options                 &server_config
+        );
 
         auto register_descriptor(int fd, uint32_t events)
             -> std::expected<void, std::string>;
@@ -33,15 +194,190 @@ namespace oreore
         auto unregister_descriptor(int fd) -> std::expected<void, std::string>;
 
         auto close_client(int client_fd, const char *reason) -> void;
-        auto accept_new_connections(void) -> void;
+        // The recorder if the client's current request was sampled, else
+        // null.
+        auto connection_trace(const client_connection &client) -> trace_recorder *;
+        [[nodiscard]] auto is_listener(int fd) const -> bool;
+        auto accept_new_connections(int listener_fd) -> void;
+        [[nodiscard]] auto at_connection_limit(void) const -> bool;
+        auto set_accepting(bool enabled) -> void;
+        [[nodiscard]] auto listener_events(void) const -> uint32_t;
+        // Feeds the controller and applies its level; runs once per loop
+        // iteration.
+        auto update_overload(std::chrono::steady_clock::duration loop_lag) -> void;
+        // Drops the first `count` bytes of the read buffer.
+        auto consume_input(client_connection &client, size_t count) -> void;
+        [[nodiscard]] auto is_shedding(void) const -> bool;
         auto handle_client_read(client_connection &client) -> void;
         auto handle_client_write(client_connection &client) -> void;
         auto queue_data_for_send(client_connection &client, std::string data_to_send)
             -> void;
+        // Queues bytes as-is, bypassing per-connection compression framing.
+        auto queue_raw_for_send(client_connection &client, std::string data_to_send)
+            -> void;
+        auto render_stats(void) -> std::string;
+        // Brings the shared-memory board up to date with the store.
+        auto publish_shared_board(void) -> void;
+        auto drain_read_buffer(client_connection &client) -> task<>;
         auto process_client_command(
             client_connection &client,
             const std::string &command_line
+        ) -> task<>;
+        auto collect_batch_line(
+            client_connection &client,
+            const std::string &line
+        ) -> task<>;
+        auto complete_batch(client_connection &client) -> task<>;
+        // Normalizes every text of an MPOST or binary batch, or names the
+        // first one that was rejected.
+        auto normalize_batch(std::span<const std::string> texts)
+            -> std::expected<std::vector<std::string>, std::string>;
+        // Runs a board command line; the caller must hold store.lock().
+        auto execute_store_command(
+            const std::string &sender_ip,
+            const std::string &command_line
+        ) -> std::string;
+        // Reply to a posted batch; the caller must hold store.lock().
+        auto posted_range_reply(uintmax_t first_id, size_t count) const -> std::string;
+        auto process_binary_frame(
+            client_connection         &client,
+            const binary_frame_header &header,
+            std::string_view           payload
+        ) -> task<>;
+
+        // Connection coroutines (server_connection.cpp). Each connection runs
+        // serve_connection, which parks on these awaitables between events.
+        struct input_awaiter
+        {
+            client_connection &client;
+
+            auto await_ready(void) const noexcept -> bool
+            {
+                return false;
+            }
+
+            auto await_suspend(std::coroutine_handle<> waiter) noexcept -> void
+            {
+                client.get_input_waiter() = waiter;
+            }
+
+            auto await_resume(void) const noexcept -> void
+            {
+            }
+        };
+
+        struct flush_awaiter
+        {
+            client_connection &client;
+
+            auto await_ready(void) const noexcept -> bool
+            {
+                return client.get_write_buffer().empty();
+            }
+
+            auto await_suspend(std::coroutine_handle<> waiter) noexcept -> void
+            {
+                client.get_flush_waiter() = waiter;
+            }
+
+            auto await_resume(void) const noexcept -> void
+            {
+            }
+        };
+
+        auto start_connection(client_connection &client) -> void;
+        auto resume_connection(
+            client_connection      &client,
+            std::coroutine_handle<> waiter
         ) -> void;
+        auto serve_connection(client_connection &client) -> task<>;
+        // Resumes once the socket delivered more bytes.
+        auto next_input(client_connection &client) -> input_awaiter;
+        // Resumes once everything queued for the peer has been sent.
+        auto flush(client_connection &client) -> flush_awaiter;
+        // Renders on a worker (or inline when the queue is full), deflating
+        // the result when a compression level is given.
+        auto render_on_worker(
+            client_connection      &client,
+            message_snapshot      &&snapshot,
+            std::optional<int>      compression_level = std::nullopt
+        ) -> render_awaiter;
+        // The full board as a compression frame, rendered and deflated off
+        // the loop and shared until the board version moves on.
+        auto serve_compressed_get(client_connection &client) -> task<std::string>;
+        // Renders a GET inline when it is small, otherwise on a worker.
+        auto serve_get(client_connection &client, const message_filter &filter)
+            -> task<std::string>;
+        // The rendering half of serve_get, for a snapshot already taken.
+        auto render_snapshot(client_connection &client, message_snapshot snapshot)
+            -> task<std::string>;
+        auto handle_render_completions(void) -> void;
+
+        // Replication (server_replication.cpp).
+        [[nodiscard]] auto is_follower(void) const -> bool;
+        [[nodiscard]] auto read_only_error(void) const -> std::string;
+        auto subscribe_replica(client_connection &client, uintmax_t from_sequence)
+            -> void;
+        auto pump_replica(client_connection &client) -> void;
+        auto publish_replication_events(void) -> void;
+        auto start_replication(void) -> void;
+        auto schedule_replication_retry(const std::string &reason) -> void;
+        auto handle_replication_link(uint32_t events) -> void;
+        auto handle_replication_timer(void) -> void;
+
+        // Cluster (server_cluster.cpp).
+        [[nodiscard]] auto is_router(void) const -> bool;
+        auto connect_shard(size_t shard) -> std::expected<void, std::string>;
+        auto fail_shard(size_t shard, const std::string &reason) -> void;
+        auto handle_shard_event(int fd, uint32_t events) -> void;
+        auto deliver_shard_reply(uint64_t key, std::string text) -> void;
+        auto resume_ready_shard_calls(void) -> void;
+        // Sends payloads[i] to shards[i]; resumes once all replied.
+        auto call_shards(
+            client_connection           &client,
+            std::span<const size_t>      shards,
+            std::span<const std::string> payloads
+        ) -> shard_call;
+        auto forward_to_shard(
+            client_connection &client,
+            size_t             shard,
+            std::string        command
+        ) -> task<std::string>;
+        // A router's handling of every command but STATS, COMPRESS and
+        // MPOST, which it collects and hands to route_batch.
+        auto route_command(
+            client_connection &client,
+            const std::string &command_token,
+            const std::string &command_line
+        ) -> task<std::string>;
+        auto route_batch(client_connection &client, std::span<const std::string> texts)
+            -> task<std::string>;
+        // Shard side of a routed frame.
+        auto run_routed_command(
+            client_connection &client,
+            const std::string &sender_ip,
+            std::string_view   command
+        ) -> task<std::string>;
+
+        // Hot restart (server_hot_restart.cpp).
+        auto adopt_handoff(handoff_state &&handoff)
+            -> std::expected<void, std::string>;
+        // The store and the given clients, written out for the replacement.
+        auto write_handoff_state(std::span<client_connection *const> clients)
+            -> std::expected<handoff_state_file, std::string>;
+        auto handle_handoff_request(void) -> void;
+        auto handle_takeover_event(uint32_t events) -> void;
+        // Times the takeover out, or sends it once nothing is in flight.
+        auto advance_takeover(void) -> void;
+        // Drops the takeover and picks up what paused meanwhile.
+        auto abort_takeover(const std::string &reason) -> void;
+        // Past the request: client input and accepts are on hold.
+        [[nodiscard]] auto is_handing_off(void) const -> bool;
+        // The replacement holds copies of the clients' buffers, so their
+        // output is on hold too.
+        [[nodiscard]] auto is_handing_off_clients(void) const -> bool;
+        auto begin_drain(bool clients_handed_off) -> void;
+        [[nodiscard]] auto drain_finished(void) const -> bool;
 
       public:
         server(const server &)                     = delete;
@@ -52,7 +388,7 @@ namespace oreore
 
         ~server(void);
 
-        static auto make(uint16_t port, int backlog)
+        static auto make(const server_options &server_config)
             -> std::expected<server, std::string>;
         auto run(void) -> void;
     };
@@ -60,6 +396,10 @@ namespace oreore
     auto make_socket_non_blocking(int socket_fd)
         -> std::expected<void, std::string>;
 
+    // Parses the arguments following "GET".
+    auto parse_get_filter(std::istream &arguments)
+        -> std::expected<message_filter, std::string>;
+
 }
 
 #endif
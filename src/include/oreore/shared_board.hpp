@@ -0,0 +1,91 @@
+#ifndef OREORE_SHARED_BOARD_HPP
+#define OREORE_SHARED_BOARD_HPP
+
+#include <oreore/message_store.hpp>
+#include <oreore/shared_board_layout.hpp>
+
+#include <expected>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace oreore
+{
+    inline constexpr size_t DEFAULT_SHARED_BOARD_CAPACITY = 64 * 1024 * 1024;
+    // Where glibc keeps POSIX shared memory objects, so that a finished
+    // segment can be renamed over the published one.
+    inline constexpr std::string_view SHARED_MEMORY_DIRECTORY = "/dev/shm";
+
+    // Server side of the shared-memory board: mirrors the message store
+    // into a POSIX shared memory segment that local processes map with
+    // shared_board_reader (see shared_board_layout.hpp for the format).
+    class shared_board
+    {
+      private:
+        char  *mapping;
+        size_t mapping_size;
+        // The segment is built under staging_name and renamed to name by
+        // go_live(), so readers never see it half filled.
+        std::string name;
+        std::string staging_name;
+        bool        live;
+        // Set once a replacement process is taking over the name.
+        bool handed_over;
+        // Store events mirrored so far, and where each message's record
+        // starts, by store position.
+        uintmax_t             published_events;
+        std::vector<uint64_t> record_offsets;
+
+        shared_board(
+            char       *segment,
+            size_t      size,
+            std::string public_name,
+            std::string staged_name
+        );
+
+        auto header(void) -> shared_board_header &;
+        auto records(void) -> char *;
+        // Retires a live segment or removes a staged one, then unmaps it.
+        auto release(void) -> void;
+        auto append_record(const message &msg) -> bool;
+        auto update_record(size_t position, const message &msg) -> void;
+
+      public:
+        shared_board(const shared_board &)                     = delete;
+        auto operator=(const shared_board &) -> shared_board & = delete;
+
+        shared_board(shared_board &&other) noexcept;
+        auto operator=(shared_board &&other) noexcept -> shared_board &;
+
+        // Leaves the name in place, marked retired unless handed over: a
+        // replacement process may already have published its own segment
+        // under it.
+        ~shared_board(void);
+
+        // Creates the segment under a private name; any segment already
+        // published under `name` stays readable until go_live().
+        static auto make(const std::string &name, size_t capacity)
+            -> std::expected<shared_board, std::string>;
+
+        // Whether the store has events not yet published. Only the event
+        // loop changes the store, so the loop may ask without the lock.
+        [[nodiscard]] auto is_behind(const message_store &store) const -> bool;
+        // Mirrors store events not yet published. The caller must hold
+        // store.lock().
+        auto publish(const message_store &store) -> void;
+        // Puts the segment under its name in one step, then retires the one
+        // it replaced (a previous process's, during a hot restart).
+        auto go_live(void) -> std::expected<void, std::string>;
+        // The replacement's go_live() retires this segment, so exiting first
+        // must not: readers would find a retired board under the name.
+        auto hand_over(void) -> void;
+        auto retire(void) -> void;
+
+        [[nodiscard]] auto get_used_bytes(void) const -> uint64_t;
+        [[nodiscard]] auto is_truncated(void) const -> bool;
+    };
+
+}
+
+#endif
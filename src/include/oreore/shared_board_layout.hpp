@@ -0,0 +1,97 @@
+#ifndef OREORE_SHARED_BOARD_LAYOUT_HPP
+#define OREORE_SHARED_BOARD_LAYOUT_HPP
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace oreore
+{
+    // Layout of the shared-memory board (--shm-board). Shared by the server
+    // and the header-only reader, so it depends on nothing else.
+    //
+    // The segment is a shared_board_header, an index of index_slots record
+    // offsets, then message records appended back to back, each padded to
+    // 8 bytes. Records are never moved, and everything but their reaction
+    // fields is immutable once `message_count` covers them, so readers copy
+    // posts without retrying. Slot n of the index holds the offset of record
+    // n * SHARED_BOARD_INDEX_STRIDE, letting a read start near any position.
+    //
+    // A reaction rewrites the reaction and counters of its record in place
+    // under the record's own seqlock: `sequence` is odd while the server is
+    // changing them, and a reader that saw it change copies them again.
+    inline constexpr uint64_t SHARED_BOARD_MAGIC          = 0x4452414f4245524f; // "OREBOARD"
+    inline constexpr uint32_t SHARED_BOARD_LAYOUT_VERSION = 2;
+    inline constexpr size_t   SHARED_BOARD_ALIGNMENT      = 8;
+    inline constexpr size_t   SHARED_BOARD_INDEX_STRIDE   = 64;
+
+    struct shared_board_header
+    {
+        uint64_t magic;
+        uint32_t layout_version;
+        uint32_t header_size;
+        // Bytes available for records after the index.
+        uint64_t capacity;
+        // Entries in the index that follows the header.
+        uint64_t index_slots;
+        // Non-zero once the publishing server has exited or been replaced;
+        // the replacement publishes a fresh segment under the same name.
+        uint64_t retired;
+        // Same as the board version of conditional GET.
+        uint64_t board_version;
+        // Records readers may copy; published after the records themselves.
+        uint64_t message_count;
+        // Bytes of records published.
+        uint64_t used;
+        // Non-zero once a message did not fit; later posts are missing.
+        uint64_t truncated;
+    };
+
+    // Followed by sender_length bytes of sender and text_length bytes of
+    // text (escaped as in GET output). reaction: 0 none, 1 HAPPY, 2 SAD.
+    struct shared_board_record
+    {
+        uint64_t id;
+        // Seqlock over reaction, happy and sad.
+        uint64_t sequence;
+        uint64_t reaction;
+        uint64_t happy;
+        uint64_t sad;
+        uint32_t sender_length;
+        uint32_t text_length;
+    };
+
+    // Enough index slots for a segment filled with the smallest records.
+    inline auto shared_board_index_slots(size_t capacity) -> size_t
+    {
+        return capacity / (SHARED_BOARD_INDEX_STRIDE * sizeof(shared_board_record)) + 1;
+    }
+
+    inline auto shared_board_records_offset(size_t index_slots) -> size_t
+    {
+        return sizeof(shared_board_header) + index_slots * sizeof(uint64_t);
+    }
+
+    inline auto shared_board_record_size(size_t sender_length, size_t text_length)
+        -> size_t
+    {
+        size_t size = sizeof(shared_board_record) + sender_length + text_length;
+        return (size + SHARED_BOARD_ALIGNMENT - 1) & ~(SHARED_BOARD_ALIGNMENT - 1);
+    }
+
+    // Mutable fields are only touched through these, on both sides.
+    inline auto shared_load(const uint64_t &field, std::memory_order order)
+        -> uint64_t
+    {
+        return std::atomic_ref<uint64_t>(const_cast<uint64_t &>(field)).load(order);
+    }
+
+    inline auto shared_store(uint64_t &field, uint64_t value, std::memory_order order)
+        -> void
+    {
+        std::atomic_ref<uint64_t>(field).store(value, order);
+    }
+
+}
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef OREORE_SHARED_BOARD_READER_HPP
+#define OREORE_SHARED_BOARD_READER_HPP
+
+#include <oreore/shared_board_layout.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <expected>
+#include <fcntl.h>
+#include <span>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace oreore
+{
+    // Spins a reader waits on a record mid-update before yielding the CPU.
+    inline constexpr unsigned SHARED_BOARD_SPIN_LIMIT = 64;
+
+    struct shared_board_message
+    {
+        uint64_t    id;
+        uint64_t    reaction; // 0 none, 1 HAPPY, 2 SAD
+        uint64_t    happy;
+        uint64_t    sad;
+        std::string sender;
+        std::string text;
+    };
+
+    // Header-only reader for a board published with --shm-board <name>.
+    // Once open() has mapped the segment, reading it is plain memory
+    // access: no syscalls and no work for the server.
+    class shared_board_reader
+    {
+      private:
+        const char *mapping;
+        size_t      mapping_size;
+
+        shared_board_reader(const char *segment, size_t size)
+            : mapping(segment)
+            , mapping_size(size)
+        {
+        }
+
+        [[nodiscard]] auto header(void) const -> const shared_board_header &
+        {
+            return *reinterpret_cast<const shared_board_header *>(mapping);
+        }
+
+        static auto back_off(unsigned attempt) -> void
+        {
+            if (attempt >= SHARED_BOARD_SPIN_LIMIT)
+            {
+                std::this_thread::yield();
+                return;
+            }
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+
+        // Copies a record's reaction state under its seqlock.
+        static auto load_reactions(
+            const shared_board_record &record,
+            shared_board_message      &out
+        ) -> void
+        {
+            for (unsigned attempt = 0;; ++attempt)
+            {
+                uint64_t sequence = shared_load(record.sequence, std::memory_order_acquire);
+                if (sequence % 2 == 0)
+                {
+                    out.reaction = shared_load(record.reaction, std::memory_order_relaxed);
+                    out.happy    = shared_load(record.happy, std::memory_order_relaxed);
+                    out.sad      = shared_load(record.sad, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (shared_load(record.sequence, std::memory_order_relaxed) == sequence)
+                    {
+                        return;
+                    }
+                }
+                back_off(attempt);
+            }
+        }
+
+        // Calls visit(position, record, bytes) for the published records in
+        // [first, last), starting from the nearest index entry. Only id and
+        // the lengths are read outside an atomic; they never change once
+        // message_count covers the record.
+        template <typename visitor>
+        auto for_each_record(size_t first, size_t last, visitor &&visit) const -> void
+        {
+            const shared_board_header &board = header();
+            const char                *records
+                = mapping + shared_board_records_offset(board.index_slots);
+            const auto *index = reinterpret_cast<const uint64_t *>(
+                mapping + sizeof(shared_board_header)
+            );
+
+            size_t   position = first - first % SHARED_BOARD_INDEX_STRIDE;
+            uint64_t offset   = index[position / SHARED_BOARD_INDEX_STRIDE];
+            for (; position < last; ++position)
+            {
+                if (offset > board.capacity
+                    || board.capacity - offset < sizeof(shared_board_record))
+                {
+                    return; // not a board this reader understands
+                }
+                const auto *record
+                    = reinterpret_cast<const shared_board_record *>(records + offset);
+                size_t size
+                    = shared_board_record_size(record->sender_length, record->text_length);
+                if (size > board.capacity - offset)
+                {
+                    return;
+                }
+                if (position >= first)
+                {
+                    visit(position, *record, records + offset + sizeof(*record));
+                }
+                offset += size;
+            }
+        }
+
+      public:
+        shared_board_reader(const shared_board_reader &) = delete;
+        auto operator=(const shared_board_reader &) -> shared_board_reader & = delete;
+
+        shared_board_reader(shared_board_reader &&other) noexcept
+            : mapping(std::exchange(other.mapping, nullptr))
+            , mapping_size(std::exchange(other.mapping_size, 0))
+        {
+        }
+
+        auto operator=(shared_board_reader &&other) noexcept -> shared_board_reader &
+        {
+            if (this != &other)
+            {
+                if (mapping)
+                {
+                    munmap(const_cast<char *>(mapping), mapping_size);
+                }
+                mapping      = std::exchange(other.mapping, nullptr);
+                mapping_size = std::exchange(other.mapping_size, 0);
+            }
+            return *this;
+        }
+
+        ~shared_board_reader(void)
+        {
+            if (mapping)
+            {
+                munmap(const_cast<char *>(mapping), mapping_size);
+            }
+        }
+
+        // `name` as given to --shm-board, e.g. "/oreore-board".
+        static auto open(const std::string &name)
+            -> std::expected<shared_board_reader, std::string>
+        {
+            int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+            if (fd == -1)
+            {
+                return std::unexpected(
+                    "shm_open " + name + " failed: " + std::strerror(errno)
+                );
+            }
+            struct stat status {};
+            if (fstat(fd, &status) == -1)
+            {
+                int error = errno;
+                ::close(fd);
+                return std::unexpected(
+                    "fstat " + name + " failed: " + std::strerror(error)
+                );
+            }
+            auto size = static_cast<size_t>(status.st_size);
+            void *segment
+                = size >= sizeof(shared_board_header)
+                    ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)
+                    : MAP_FAILED;
+            int error = errno;
+            ::close(fd);
+            if (segment == MAP_FAILED)
+            {
+                return std::unexpected(
+                    "mmap " + name + " failed: " + std::strerror(error)
+                );
+            }
+
+            shared_board_reader reader(static_cast<const char *>(segment), size);
+            const shared_board_header &board = reader.header();
+            if (board.magic != SHARED_BOARD_MAGIC
+                || board.layout_version != SHARED_BOARD_LAYOUT_VERSION
+                || board.header_size != sizeof(shared_board_header)
+                || board.index_slots == 0
+                || board.index_slots
+                       > (size - sizeof(shared_board_header)) / sizeof(uint64_t)
+                || board.capacity > size - shared_board_records_offset(board.index_slots))
+            {
+                return std::unexpected(name + " is not a shared board");
+            }
+            return reader;
+        }
+
+        // Cheap change check: equal versions mean an unchanged board.
+        [[nodiscard]] auto version(void) const -> uint64_t
+        {
+            return shared_load(header().board_version, std::memory_order_acquire);
+        }
+
+        // The server went away or handed over; open the name again.
+        [[nodiscard]] auto retired(void) const -> bool
+        {
+            return shared_load(header().retired, std::memory_order_acquire) != 0;
+        }
+
+        // Some posts did not fit in the segment and are missing.
+        [[nodiscard]] auto truncated(void) const -> bool
+        {
+            return shared_load(header().truncated, std::memory_order_acquire) != 0;
+        }
+
+        // Published messages from position `first` (0-based, in posting
+        // order) on. Posts never change once published, so pass the number
+        // of messages already read to fetch only new ones, and use
+        // refresh_reactions() for the reactions to those. Each message is
+        // consistent on its own; reactions are as of when it was copied.
+        [[nodiscard]] auto read(size_t first = 0) const
+            -> std::vector<shared_board_message>
+        {
+            size_t count = shared_load(header().message_count, std::memory_order_acquire);
+            std::vector<shared_board_message> messages;
+            if (first >= count)
+            {
+                return messages;
+            }
+            messages.reserve(count - first);
+            for_each_record(
+                first,
+                count,
+                [&messages](size_t, const shared_board_record &record, const char *bytes)
+                {
+                    shared_board_message &copy = messages.emplace_back(
+                        shared_board_message {
+                            record.id,
+                            0,
+                            0,
+                            0,
+                            std::string(bytes, record.sender_length),
+                            std::string(bytes + record.sender_length, record.text_length),
+                        }
+                    );
+                    load_reactions(record, copy);
+                }
+            );
+            return messages;
+        }
+
+        // Updates the reaction state of messages read earlier, where
+        // messages[0] was read at position `first`.
+        auto refresh_reactions(std::span<shared_board_message> messages, size_t first) const
+            -> void
+        {
+            size_t count = shared_load(header().message_count, std::memory_order_acquire);
+            if (first >= count)
+            {
+                return;
+            }
+            for_each_record(
+                first,
+                std::min(count, first + messages.size()),
+                [&messages, first](
+                    size_t                     position,
+                    const shared_board_record &record,
+                    const char *
+                )
+                {
+                    load_reactions(record, messages[position - first]);
+                }
+            );
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef OREORE_SOCKET_TUNING_HPP
+#define OREORE_SOCKET_TUNING_HPP
+
+#include <expected>
+#include <optional>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+namespace oreore
+{
+    inline constexpr int LOW_LATENCY_SOCKET_BUFFER_SIZE = 256 * 1024;
+    inline constexpr int LOW_LATENCY_BUSY_POLL_US       = 50;
+    inline constexpr int DEFER_ACCEPT_SECONDS           = 1;
+
+    enum class latency_profile : uint8_t
+    {
+        standard,    // kernel defaults
+        low_latency, // NODELAY/QUICKACK, sized buffers, SO_BUSY_POLL
+    };
+
+    auto parse_latency_profile(std::string_view name)
+        -> std::optional<latency_profile>;
+
+    // How new connections are spread when several processes wait on the
+    // same port.
+    enum class listener_distribution : uint8_t
+    {
+        shared,    // every waiter on a listener wakes for a connection
+        exclusive, // EPOLLEXCLUSIVE: one waiter per inherited listener wakes
+        reuseport, // SO_REUSEPORT: each process binds its own listener
+    };
+
+    auto parse_listener_distribution(std::string_view name)
+        -> std::optional<listener_distribution>;
+
+    // TCP listeners, before listen(): buffer sizes set here are inherited by
+    // accepted sockets, and TCP_DEFER_ACCEPT holds connections in the kernel
+    // until the client's first bytes arrive.
+    auto tune_listener(int listener_fd, latency_profile profile)
+        -> std::expected<void, std::string>;
+    // Accepted TCP sockets.
+    auto tune_connection(int client_fd, latency_profile profile)
+        -> std::expected<void, std::string>;
+    // TCP_QUICKACK is cleared by the kernel as it sees fit, so low-latency
+    // connections re-arm it after every read.
+    auto rearm_quick_ack(int client_fd) -> void;
+
+}
+
+#endif
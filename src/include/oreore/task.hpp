@@ -0,0 +1,228 @@
+#ifndef OREORE_TASK_HPP
+#define OREORE_TASK_HPP
+
+#include <oreore/buffer_pool.hpp>
+
+#include <coroutine>
+#include <cstdlib>
+#include <optional>
+#include <utility>
+
+namespace oreore
+{
+    // Coroutine frames come from the per-thread buffer pool, so the frame a
+    // command allocates on every call is usually the one the previous
+    // command just released.
+    struct pooled_frame
+    {
+        static auto operator new(size_t bytes) -> void *
+        {
+            return buffer_pool::local().allocate(bytes);
+        }
+
+        static auto operator delete(void *frame, size_t bytes) -> void
+        {
+            buffer_pool::local().deallocate(frame, bytes);
+        }
+    };
+
+    template <typename T>
+    class task;
+
+    namespace detail
+    {
+        // Resumes whoever awaited the finished task, if it had to wait. A
+        // task that finished synchronously, or a top-level one, stays
+        // suspended at its end until its owner destroys it.
+        struct final_awaiter
+        {
+            auto await_ready(void) const noexcept -> bool
+            {
+                return false;
+            }
+
+            template <typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> finished
+            ) const noexcept -> std::coroutine_handle<>
+            {
+                return finished.promise().continuation;
+            }
+
+            auto await_resume(void) const noexcept -> void
+            {
+            }
+        };
+
+        struct promise_base : pooled_frame
+        {
+            std::coroutine_handle<> continuation = std::noop_coroutine();
+
+            auto initial_suspend(void) const noexcept -> std::suspend_always
+            {
+                return {};
+            }
+
+            auto final_suspend(void) const noexcept -> final_awaiter
+            {
+                return {};
+            }
+
+            // The server reports failures through return values, never
+            // exceptions.
+            auto unhandled_exception(void) const noexcept -> void
+            {
+                std::abort();
+            }
+        };
+
+        template <typename T>
+        struct promise : promise_base
+        {
+            std::optional<T> value;
+
+            auto get_return_object(void) -> task<T>;
+
+            auto return_value(T result) -> void
+            {
+                value = std::move(result);
+            }
+
+            auto take_value(void) -> T
+            {
+                return std::move(*value);
+            }
+        };
+
+        template <>
+        struct promise<void> : promise_base
+        {
+            auto get_return_object(void) -> task<void>;
+
+            auto return_void(void) const noexcept -> void
+            {
+            }
+
+            auto take_value(void) const noexcept -> void
+            {
+            }
+        };
+    }
+
+    // Lazily started coroutine. Awaiting a task runs it and resumes the
+    // awaiter when it finishes; the owner of an outermost task starts it by
+    // resuming get_handle().
+    // Destroying a task destroys its frame along with any task it is
+    // suspended on.
+    template <typename T = void>
+    class [[nodiscard]] task
+    {
+      public:
+        using promise_type = detail::promise<T>;
+
+      private:
+        std::coroutine_handle<promise_type> handle;
+
+      public:
+        task(void) noexcept : handle(nullptr)
+        {
+        }
+
+        explicit task(std::coroutine_handle<promise_type> coroutine) noexcept
+            : handle(coroutine)
+        {
+        }
+
+        task(const task &)                     = delete;
+        auto operator=(const task &) -> task & = delete;
+
+        task(task &&other) noexcept : handle(std::exchange(other.handle, nullptr))
+        {
+        }
+
+        auto operator=(task &&other) noexcept -> task &
+        {
+            if (this != &other)
+            {
+                if (handle)
+                {
+                    handle.destroy();
+                }
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+
+        ~task(void)
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+        }
+
+        [[nodiscard]] auto valid(void) const -> bool
+        {
+            return static_cast<bool>(handle);
+        }
+
+        [[nodiscard]] auto get_handle(void) const -> std::coroutine_handle<>
+        {
+            return handle;
+        }
+
+        auto operator co_await(void) noexcept
+        {
+            struct awaiter
+            {
+                std::coroutine_handle<promise_type> callee;
+
+                auto await_ready(void) const noexcept -> bool
+                {
+                    return false;
+                }
+
+                // Runs the callee right away. Most commands finish without
+                // suspending, and then the caller carries on without a
+                // suspension either, so long pipelines do not pile up
+                // frames on the stack. Everything runs on the event loop
+                // thread, so a suspended callee cannot finish before its
+                // continuation is set here.
+                auto await_suspend(std::coroutine_handle<> caller) noexcept -> bool
+                {
+                    callee.resume();
+                    if (callee.done())
+                    {
+                        return false;
+                    }
+                    callee.promise().continuation = caller;
+                    return true;
+                }
+
+                auto await_resume(void) -> T
+                {
+                    return callee.promise().take_value();
+                }
+            };
+            return awaiter { handle };
+        }
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        auto promise<T>::get_return_object(void) -> task<T>
+        {
+            return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+        }
+
+        inline auto promise<void>::get_return_object(void) -> task<void>
+        {
+            return task<void>(
+                std::coroutine_handle<promise<void>>::from_promise(*this)
+            );
+        }
+    }
+
+}
+
+#endif
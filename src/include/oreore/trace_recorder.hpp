@@ -0,0 +1,84 @@
+#ifndef OREORE_TRACE_RECORDER_HPP
+#define OREORE_TRACE_RECORDER_HPP
+
+#include <oreore/scoped_file_descriptor.hpp>
+
+#include <chrono>
+#include <expected>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+namespace oreore
+{
+    inline constexpr uint32_t DEFAULT_TRACE_SAMPLE_EVERY = 100;
+    inline constexpr size_t   TRACE_FLUSH_BYTES          = 64 * 1024;
+
+    // Writes the phases of sampled requests as Chrome trace "complete"
+    // events, viewable in chrome://tracing or Perfetto. Each connection is
+    // shown as its own thread. The JSON array is never closed, which both
+    // viewers accept, so a killed server still leaves a loadable file.
+    class trace_recorder
+    {
+      public:
+        using clock = std::chrono::steady_clock;
+
+      private:
+        scoped_file_descriptor file;
+        uint32_t               sample_every;
+        uint64_t               sample_counter;
+        std::string            pending;
+        int                    process_id;
+
+        trace_recorder(scoped_file_descriptor &&trace_file, uint32_t every);
+
+      public:
+        trace_recorder(const trace_recorder &)                     = delete;
+        auto operator=(const trace_recorder &) -> trace_recorder & = delete;
+
+        ~trace_recorder(void);
+
+        // Truncates `path`. One request in `every` is recorded.
+        static auto make(const std::string &path, uint32_t every)
+            -> std::expected<std::unique_ptr<trace_recorder>, std::string>;
+
+        // Decides whether the request about to start is recorded.
+        [[nodiscard]] auto sample(void) -> bool;
+        auto record(
+            std::string_view  name,
+            clock::time_point start,
+            clock::time_point end,
+            int               connection_fd,
+            std::string_view  detail = {}
+        ) -> void;
+        // Writes out buffered events; the loop calls this before it sleeps.
+        auto flush(void) -> void;
+    };
+
+    // Records its own lifetime as a span. Does nothing without a recorder,
+    // which is how unsampled requests pass through.
+    class trace_span
+    {
+      private:
+        trace_recorder                   *recorder;
+        std::string_view                  name;
+        int                               connection_fd;
+        std::string                       detail;
+        trace_recorder::clock::time_point start;
+
+      public:
+        trace_span(trace_recorder *target, std::string_view span_name, int fd);
+        trace_span(const trace_span &)                     = delete;
+        auto operator=(const trace_span &) -> trace_span & = delete;
+        ~trace_span(void);
+
+        // Shown under "args" in the viewer.
+        auto set_detail(std::string_view text) -> void;
+        // Records the span now rather than at destruction.
+        auto end(void) -> void;
+    };
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef OREORE_TRAFFIC_RECORD_HPP
+#define OREORE_TRAFFIC_RECORD_HPP
+
+#include <oreore/binary_protocol.hpp>
+
+#include <optional>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+namespace oreore
+{
+    // File written by --record (integers little-endian):
+    //   8 bytes   magic "ORETRAF1"
+    //   then records:
+    //   offset 0  : uint8_t  kind
+    //   offset 1  : uint32_t connection (numbered in order of first record)
+    //   offset 5  : uint32_t microseconds since the previous record
+    //   offset 9  : uint32_t payload_length
+    //   offset 13 : payload_length bytes of payload
+    // A server killed mid-write leaves a truncated last record, which
+    // readers treat as the end of the file.
+    inline constexpr std::string_view TRAFFIC_MAGIC              = "ORETRAF1";
+    inline constexpr size_t           TRAFFIC_RECORD_HEADER_SIZE = 13;
+    inline constexpr size_t           TRAFFIC_FLUSH_BYTES        = 64 * 1024;
+
+    enum class traffic_kind : uint8_t
+    {
+        open  = 0x01, // payload: the peer's identity string
+        text  = 0x02, // payload: one command line, without its newline
+        frame = 0x03, // payload: one binary frame, header included
+        close = 0x04, // payload: empty
+    };
+
+    struct traffic_record
+    {
+        traffic_kind     kind;
+        uint32_t         connection;
+        uint32_t         delay_us;
+        std::string_view payload;
+    };
+
+    inline auto encode_traffic_record(
+        std::string     &out,
+        traffic_kind     kind,
+        uint32_t         connection,
+        uint32_t         delay_us,
+        std::string_view payload
+    ) -> void
+    {
+        char header[TRAFFIC_RECORD_HEADER_SIZE];
+        header[0] = static_cast<char>(kind);
+        store_le32(header + 1, connection);
+        store_le32(header + 5, delay_us);
+        store_le32(header + 9, static_cast<uint32_t>(payload.size()));
+        out.append(header, sizeof(header));
+        out.append(payload);
+    }
+
+    // Decodes the record at the front of `buffer`; std::nullopt until a
+    // complete one is available. The payload views into `buffer`.
+    inline auto decode_traffic_record(std::string_view buffer)
+        -> std::optional<traffic_record>
+    {
+        if (buffer.size() < TRAFFIC_RECORD_HEADER_SIZE)
+        {
+            return std::nullopt;
+        }
+        uint32_t payload_length = load_le32(buffer.data() + 9);
+        if (buffer.size() - TRAFFIC_RECORD_HEADER_SIZE < payload_length)
+        {
+            return std::nullopt;
+        }
+        return traffic_record {
+            static_cast<traffic_kind>(buffer[0]),
+            load_le32(buffer.data() + 1),
+            load_le32(buffer.data() + 5),
+            buffer.substr(TRAFFIC_RECORD_HEADER_SIZE, payload_length),
+        };
+    }
+
+}
+
+#endif
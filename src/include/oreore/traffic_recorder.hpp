@@ -0,0 +1,70 @@
+#ifndef OREORE_TRAFFIC_RECORDER_HPP
+#define OREORE_TRAFFIC_RECORDER_HPP
+
+#include <oreore/client_connection.hpp>
+#include <oreore/scoped_file_descriptor.hpp>
+#include <oreore/traffic_record.hpp>
+
+#include <chrono>
+#include <expected>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace oreore
+{
+    // Records every command each client sends, as the server split it, in
+    // the format of traffic_record.hpp. Replaying the file against another
+    // build reproduces the same per-connection streams and interleaving.
+    class traffic_recorder
+    {
+      public:
+        using clock = std::chrono::steady_clock;
+
+      private:
+        scoped_file_descriptor file;
+        std::string            pending;
+        // Socket -> recorded connection number, for connections seen so
+        // far. File descriptors are reused, so numbers are not.
+        std::unordered_map<int, uint32_t> connections;
+        uint32_t                          next_connection;
+        clock::time_point                 last_record;
+        uint64_t                          recorded_commands;
+
+        explicit traffic_recorder(scoped_file_descriptor &&record_file);
+
+        auto append(
+            traffic_kind     kind,
+            uint32_t         connection,
+            std::string_view payload
+        ) -> void;
+
+      public:
+        traffic_recorder(const traffic_recorder &)                     = delete;
+        auto operator=(const traffic_recorder &) -> traffic_recorder & = delete;
+
+        ~traffic_recorder(void);
+
+        // Truncates `path`.
+        static auto make(const std::string &path)
+            -> std::expected<std::unique_ptr<traffic_recorder>, std::string>;
+
+        // A text command line or a whole binary frame. The first record of
+        // a connection is preceded by its "open" record.
+        auto record(
+            const client_connection &client,
+            traffic_kind             kind,
+            std::string_view         payload
+        ) -> void;
+        auto record_close(int connection_fd) -> void;
+        // Writes out buffered records; the loop calls this before it sleeps.
+        auto flush(void) -> void;
+
+        [[nodiscard]] auto get_recorded_commands(void) const -> uint64_t;
+    };
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <string_view>
 
 inline constexpr const char logo[] = R"(
   ___  _ __ ___  ___  _ __ ___       ___  ___ _ ____   _____ _ __
@@ -17,14 +18,206 @@ auto main(int argc, const char *argv[]) -> int
     // get the port from the command line arguments, if provided
     if (argc < 2)
     {
-        std::cerr << "Usage: " << argv[0] << " <port>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <port|endpoint> [options]"
+                  << std::endl;
         return EXIT_FAILURE;
     }
-    uint16_t port = std::atoi(argv[1]) & 0xFFFF; // 16-bit port number
+
+    oreore::server_options options;
+    auto                   primary_endpoint = oreore::parse_listen_endpoint(argv[1]);
+    if (!primary_endpoint)
+    {
+        std::cerr << primary_endpoint.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+    options.listen_endpoints.push_back(std::move(primary_endpoint.value()));
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string_view argument(argv[i]);
+        if (argument == "--listen" && i + 1 < argc)
+        {
+            auto endpoint = oreore::parse_listen_endpoint(argv[++i]);
+            if (!endpoint)
+            {
+                std::cerr << endpoint.error() << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.listen_endpoints.push_back(std::move(endpoint.value()));
+        }
+        else if (argument == "--follow" && i + 1 < argc)
+        {
+            options.primary_address = argv[++i];
+        }
+        else if (argument == "--handoff-socket" && i + 1 < argc)
+        {
+            options.handoff_socket_path = argv[++i];
+        }
+        else if (argument == "--takeover" && i + 1 < argc)
+        {
+            options.takeover_socket_path = argv[++i];
+        }
+        else if (argument == "--takeover-clients")
+        {
+            options.takeover_clients = true;
+        }
+        else if (argument == "--latency-profile" && i + 1 < argc)
+        {
+            auto profile = oreore::parse_latency_profile(argv[++i]);
+            if (!profile)
+            {
+                std::cerr << "Unknown latency profile: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.latency = *profile;
+        }
+        else if (argument == "--listener-distribution" && i + 1 < argc)
+        {
+            auto distribution = oreore::parse_listener_distribution(argv[++i]);
+            if (!distribution)
+            {
+                std::cerr << "Unknown listener distribution: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.distribution = *distribution;
+        }
+        else if (argument == "--no-connection-log")
+        {
+            options.log_connections = false;
+        }
+        else if (argument == "--busy-spin-us" && i + 1 < argc)
+        {
+            auto microseconds = oreore::parse_unsigned(argv[++i]);
+            if (!microseconds)
+            {
+                std::cerr << "Invalid --busy-spin-us value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.busy_spin = std::chrono::microseconds(*microseconds);
+        }
+        else if (argument == "--render-workers" && i + 1 < argc)
+        {
+            auto workers = oreore::parse_unsigned(argv[++i]);
+            if (!workers || *workers > oreore::MAX_RENDER_WORKERS)
+            {
+                std::cerr << "Invalid --render-workers value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.render_workers = *workers;
+        }
+        else if (argument == "--max-message-bytes" && i + 1 < argc)
+        {
+            auto bytes = oreore::parse_unsigned(argv[++i]);
+            if (!bytes || *bytes == 0)
+            {
+                std::cerr << "Invalid --max-message-bytes value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.max_message_length = *bytes;
+        }
+        else if (argument == "--trace-file" && i + 1 < argc)
+        {
+            options.trace_path = argv[++i];
+        }
+        else if (argument == "--trace-sample" && i + 1 < argc)
+        {
+            auto every = oreore::parse_unsigned(argv[++i]);
+            if (!every || *every == 0 || *every > UINT32_MAX)
+            {
+                std::cerr << "Invalid --trace-sample value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.trace_sample_every = static_cast<uint32_t>(*every);
+        }
+        else if (argument == "--record" && i + 1 < argc)
+        {
+            options.record_path = argv[++i];
+        }
+        else if (argument == "--shm-board" && i + 1 < argc)
+        {
+            options.shared_board_name = argv[++i];
+        }
+        else if (argument == "--shm-board-size" && i + 1 < argc)
+        {
+            auto bytes = oreore::parse_unsigned(argv[++i]);
+            if (!bytes || *bytes == 0)
+            {
+                std::cerr << "Invalid --shm-board-size value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.shared_board_capacity = *bytes;
+        }
+        else if (argument == "--max-connections" && i + 1 < argc)
+        {
+            auto connections = oreore::parse_unsigned(argv[++i]);
+            if (!connections)
+            {
+                std::cerr << "Invalid --max-connections value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.max_connections = *connections;
+        }
+        else if (argument == "--overload-lag-ms" && i + 1 < argc)
+        {
+            auto milliseconds = oreore::parse_unsigned(argv[++i]);
+            if (!milliseconds)
+            {
+                std::cerr << "Invalid --overload-lag-ms value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.overload.lag_limit = std::chrono::milliseconds(*milliseconds);
+        }
+        else if (argument == "--overload-buffer-mb" && i + 1 < argc)
+        {
+            auto megabytes = oreore::parse_unsigned(argv[++i]);
+            if (!megabytes || *megabytes > SIZE_MAX / (1024 * 1024))
+            {
+                std::cerr << "Invalid --overload-buffer-mb value: " << argv[i]
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.overload.buffered_limit = *megabytes * 1024 * 1024;
+        }
+        else if (argument == "--shard" && i + 1 < argc)
+        {
+            auto index = oreore::parse_unsigned(argv[++i]);
+            if (!index || *index >= oreore::MAX_SHARDS)
+            {
+                std::cerr << "Invalid --shard value: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.shard_index = *index;
+        }
+        else if (argument == "--route" && i + 1 < argc)
+        {
+            options.shard_addresses.push_back(argv[++i]);
+        }
+        else if (argument == "--cluster-secret" && i + 1 < argc)
+        {
+            options.cluster_secret = argv[++i];
+        }
+        else if (argument == "--huge-pages")
+        {
+            options.huge_pages = true;
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete option: " << argument
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     std::cout << logo << std::endl;
 
-    auto server_expected = oreore::server::make(port, oreore::BACKLOG_SIZE);
+    auto server_expected = oreore::server::make(options);
 
     if (!server_expected.has_value())
     {
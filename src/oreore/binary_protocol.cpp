@@ -0,0 +1,134 @@
+#include <oreore/binary_protocol.hpp>
+
+namespace oreore
+{
+    auto decode_binary_header(std::string_view buffer)
+        -> std::optional<binary_frame_header>
+    {
+        if (buffer.size() < BINARY_HEADER_SIZE)
+        {
+            return std::nullopt;
+        }
+
+        binary_frame_header header {};
+        header.opcode         = static_cast<binary_opcode>(buffer[0]);
+        header.status         = static_cast<binary_status>(buffer[1]);
+        header.request_id     = load_le32(buffer.data() + 4);
+        header.payload_length = load_le32(buffer.data() + 8);
+
+        return header;
+    }
+
+    auto encode_binary_frame(
+        binary_opcode    opcode,
+        binary_status    status,
+        uint32_t         request_id,
+        std::string_view payload
+    ) -> std::string
+    {
+        // The peer would reject the frame, and past 4 GiB the length field
+        // would wrap and desync the stream; an error frame takes its place.
+        std::string oversized_error;
+        if (payload.size() > MAX_BINARY_PAYLOAD_SIZE)
+        {
+            oversized_error = "ERR: Reply of " + std::to_string(payload.size())
+                            + " bytes exceeds the binary frame limit of "
+                            + std::to_string(MAX_BINARY_PAYLOAD_SIZE) + ".\n";
+            status  = binary_status::error;
+            payload = oversized_error;
+        }
+
+        std::string frame(BINARY_HEADER_SIZE + payload.size(), '\0');
+        frame[0] = static_cast<char>(opcode);
+        frame[1] = static_cast<char>(status);
+        store_le32(frame.data() + 4, request_id);
+        store_le32(frame.data() + 8, static_cast<uint32_t>(payload.size()));
+        frame.replace(BINARY_HEADER_SIZE, payload.size(), payload);
+
+        return frame;
+    }
+
+    auto encode_binary_id(uint64_t id) -> std::string
+    {
+        std::string encoded(sizeof(uint64_t), '\0');
+        store_le64(encoded.data(), id);
+
+        return encoded;
+    }
+
+    auto binary_opcode_name(binary_opcode opcode) -> std::string_view
+    {
+        switch (opcode)
+        {
+            case binary_opcode::post:
+                return "post";
+            case binary_opcode::get:
+                return "get";
+            case binary_opcode::happy:
+                return "happy";
+            case binary_opcode::sad:
+                return "sad";
+            case binary_opcode::post_batch:
+                return "post_batch";
+            case binary_opcode::routed:
+                return "routed";
+            case binary_opcode::router_hello:
+                return "router_hello";
+        }
+        return "unknown";
+    }
+
+    auto decode_binary_batch(std::string_view payload)
+        -> std::optional<std::vector<std::string>>
+    {
+        std::vector<std::string> texts;
+        while (!payload.empty())
+        {
+            if (payload.size() < sizeof(uint32_t))
+            {
+                return std::nullopt;
+            }
+            uint32_t text_length = load_le32(payload.data());
+            payload.remove_prefix(sizeof(uint32_t));
+            if (payload.size() < text_length)
+            {
+                return std::nullopt;
+            }
+            texts.emplace_back(payload.substr(0, text_length));
+            payload.remove_prefix(text_length);
+        }
+
+        return texts;
+    }
+
+    auto encode_routed_command(std::string_view sender_ip, std::string_view command)
+        -> std::string
+    {
+        sender_ip = sender_ip.substr(0, UINT8_MAX);
+        std::string encoded;
+        encoded.reserve(1 + sender_ip.size() + command.size());
+        encoded.push_back(static_cast<char>(sender_ip.size()));
+        encoded.append(sender_ip).append(command);
+
+        return encoded;
+    }
+
+    auto decode_routed_command(std::string_view payload)
+        -> std::optional<routed_command>
+    {
+        if (payload.empty())
+        {
+            return std::nullopt;
+        }
+        size_t sender_length = static_cast<unsigned char>(payload[0]);
+        payload.remove_prefix(1);
+        if (payload.size() < sender_length)
+        {
+            return std::nullopt;
+        }
+
+        return routed_command { payload.substr(0, sender_length),
+                                payload.substr(sender_length) };
+    }
+
+}
@@ -0,0 +1,241 @@
+#include <oreore/buffer_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/lsan_interface.h>
+#endif
+
+namespace oreore
+{
+    namespace
+    {
+        std::atomic<bool> huge_pages_enabled { false };
+
+        // First bytes of every slab, and of every oversize block.
+        struct owner_header
+        {
+            buffer_pool *owner;
+        };
+        // Keeps blocks past the header aligned as ::operator new's are.
+        inline constexpr size_t OVERSIZE_HEADER_SIZE = alignof(std::max_align_t);
+
+        auto slab_owner(void *block) -> buffer_pool *
+        {
+            auto address = reinterpret_cast<uintptr_t>(block);
+            return reinterpret_cast<owner_header *>(address & ~(POOL_SLAB_SIZE - 1))->owner;
+        }
+
+        auto class_index(size_t bytes) -> size_t
+        {
+            size_t block_size
+                = std::bit_ceil(std::max(bytes, POOL_MIN_BLOCK_SIZE));
+            return std::countr_zero(block_size)
+                 - std::countr_zero(POOL_MIN_BLOCK_SIZE);
+        }
+
+        auto map_slab(void) -> char *
+        {
+            int   flags = MAP_PRIVATE | MAP_ANONYMOUS;
+            void *slab  = MAP_FAILED;
+            if (huge_pages_enabled.load(std::memory_order_relaxed))
+            {
+                slab = mmap(
+                    nullptr,
+                    POOL_SLAB_SIZE,
+                    PROT_READ | PROT_WRITE,
+                    flags | MAP_HUGETLB,
+                    -1,
+                    0
+                );
+            }
+            if (slab == MAP_FAILED)
+            {
+                // Over-map and trim to a slab-aligned slab, so a block's
+                // slab (and owner) is found by masking its address.
+                void *region = mmap(
+                    nullptr,
+                    2 * POOL_SLAB_SIZE,
+                    PROT_READ | PROT_WRITE,
+                    flags,
+                    -1,
+                    0
+                );
+                if (region == MAP_FAILED)
+                {
+                    throw std::bad_alloc();
+                }
+                auto start   = reinterpret_cast<uintptr_t>(region);
+                auto aligned = (start + POOL_SLAB_SIZE - 1) & ~(POOL_SLAB_SIZE - 1);
+                if (aligned != start)
+                {
+                    munmap(region, aligned - start);
+                }
+                munmap(
+                    reinterpret_cast<void *>(aligned + POOL_SLAB_SIZE),
+                    start + POOL_SLAB_SIZE - aligned
+                );
+                slab = reinterpret_cast<void *>(aligned);
+                // No reserved huge pages: let THP back the slab if it can.
+                if (huge_pages_enabled.load(std::memory_order_relaxed))
+                {
+                    madvise(slab, POOL_SLAB_SIZE, MADV_HUGEPAGE);
+                }
+            }
+
+            return static_cast<char *>(slab);
+        }
+    }
+
+    buffer_pool::buffer_pool(void)
+        : in_use_counts {}
+        , oversize_in_use(0)
+        , returned(nullptr)
+        , slab_cursor(nullptr)
+        , slab_end(nullptr)
+        , slab_count(0)
+    {
+    }
+
+    auto buffer_pool::local(void) -> buffer_pool &
+    {
+        // Intentionally leaked: blocks may outlive their thread.
+        thread_local buffer_pool *pool = []
+        {
+            auto *leaked = new buffer_pool();
+#if defined(__SANITIZE_ADDRESS__)
+            // Tell LeakSanitizer the leak is deliberate.
+            __lsan_ignore_object(leaked);
+#endif
+            return leaked;
+        }();
+        return *pool;
+    }
+
+    auto buffer_pool::set_huge_pages(bool enabled) -> void
+    {
+        huge_pages_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    auto buffer_pool::carve(size_t block_size) -> void *
+    {
+        if (slab_cursor == nullptr
+            || static_cast<size_t>(slab_end - slab_cursor) < block_size)
+        {
+            char *slab = map_slab();
+            reinterpret_cast<owner_header *>(slab)->owner = this;
+            slab_cursor = slab + POOL_MIN_BLOCK_SIZE;
+            slab_end    = slab + POOL_SLAB_SIZE;
+            ++slab_count;
+        }
+
+        void *block  = slab_cursor;
+        slab_cursor += block_size;
+        return block;
+    }
+
+    auto buffer_pool::allocate(size_t bytes) -> void *
+    {
+        size_t index = class_index(bytes);
+        if (index >= POOL_CLASS_COUNT)
+        {
+            auto *block = static_cast<char *>(::operator new(OVERSIZE_HEADER_SIZE + bytes));
+            reinterpret_cast<owner_header *>(block)->owner = this;
+            oversize_in_use.fetch_add(1, std::memory_order_relaxed);
+            return block + OVERSIZE_HEADER_SIZE;
+        }
+
+        ++in_use_counts[index];
+        auto &free_list = free_lists[index];
+        if (free_list.empty())
+        {
+            reclaim_returned();
+        }
+        if (!free_list.empty())
+        {
+            void *block = free_list.back();
+            free_list.pop_back();
+            return block;
+        }
+
+        return carve(POOL_MIN_BLOCK_SIZE << index);
+    }
+
+    auto buffer_pool::deallocate(void *block, size_t bytes) -> void
+    {
+        size_t index = class_index(bytes);
+        if (index >= POOL_CLASS_COUNT)
+        {
+            char *start = static_cast<char *>(block) - OVERSIZE_HEADER_SIZE;
+            reinterpret_cast<owner_header *>(start)->owner->oversize_in_use.fetch_sub(
+                1,
+                std::memory_order_relaxed
+            );
+            ::operator delete(start);
+            return;
+        }
+
+        buffer_pool *owner = slab_owner(block);
+        if (owner == this)
+        {
+            --in_use_counts[index];
+            free_lists[index].push_back(block);
+            return;
+        }
+
+        // Another thread's block: push it onto that pool's return list.
+        auto *node  = static_cast<returned_block *>(block);
+        node->index = index;
+        node->next  = owner->returned.load(std::memory_order_relaxed);
+        while (!owner->returned.compare_exchange_weak(
+            node->next,
+            node,
+            std::memory_order_release,
+            std::memory_order_relaxed
+        ))
+        {
+        }
+    }
+
+    auto buffer_pool::reclaim_returned(void) -> void
+    {
+        if (returned.load(std::memory_order_relaxed) == nullptr)
+        {
+            return;
+        }
+        // Only the owner takes from the list, and it takes all of it, so
+        // there is no ABA hazard.
+        returned_block *node = returned.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr)
+        {
+            returned_block *next = node->next;
+            --in_use_counts[node->index];
+            free_lists[node->index].push_back(node);
+            node = next;
+        }
+    }
+
+    auto buffer_pool::get_stats(void) const -> buffer_pool_stats
+    {
+        buffer_pool_stats stats {};
+        stats.slab_count      = slab_count;
+        stats.reserved_bytes  = slab_count * POOL_SLAB_SIZE;
+        stats.huge_pages      = huge_pages_enabled.load(std::memory_order_relaxed);
+        stats.oversize_in_use = oversize_in_use.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < POOL_CLASS_COUNT; ++i)
+        {
+            stats.classes[i] = { POOL_MIN_BLOCK_SIZE << i,
+                                 in_use_counts[i],
+                                 free_lists[i].size() };
+        }
+
+        return stats;
+    }
+
+}
@@ -2,20 +2,33 @@
 
 namespace oreore
 {
-    client_connection::client_connection(int target_fd, ip_address &&target_ip)
+    client_connection::client_connection(int target_fd, peer_address &&target_peer)
         : current_fd(target_fd)
-        , current_ip_address(std::move(target_ip))
+        , current_peer_address(std::move(target_peer))
         , writing_registered(false)
+        , current_protocol_mode(protocol_mode::text)
+        , current_compression_mode(compression_mode::none)
+        , router_peer(false)
+        , traced(false)
     {
     }
 
     client_connection::client_connection(client_connection &&other) noexcept
         : current_fd(other.current_fd.release())
         , // Take ownership of the fd
-        current_ip_address(std::move(other.current_ip_address))
+        current_peer_address(std::move(other.current_peer_address))
         , read_buffer(std::move(other.read_buffer))
         , write_buffer(std::move(other.write_buffer))
         , writing_registered(other.writing_registered)
+        , current_protocol_mode(other.current_protocol_mode)
+        , current_compression_mode(other.current_compression_mode)
+        , router_peer(other.router_peer)
+        , traced(other.traced)
+        , current_batch(std::move(other.current_batch))
+        , replica_sequence(other.replica_sequence)
+        , input_waiter(std::exchange(other.input_waiter, nullptr))
+        , flush_waiter(std::exchange(other.flush_waiter, nullptr))
+        , connection_task(std::move(other.connection_task))
     {
         other.writing_registered = false;
     }
@@ -28,16 +41,25 @@ namespace oreore
             current_fd = std::move(other.current_fd); // scoped_fd move
                                                       // assignment handles
                                                       // closing old fd
-            current_ip_address       = std::move(other.current_ip_address);
+            current_peer_address     = std::move(other.current_peer_address);
             read_buffer              = std::move(other.read_buffer);
             write_buffer             = std::move(other.write_buffer);
             writing_registered       = other.writing_registered;
+            current_protocol_mode    = other.current_protocol_mode;
+            current_compression_mode = other.current_compression_mode;
+            router_peer              = other.router_peer;
+            traced                   = other.traced;
+            current_batch            = std::move(other.current_batch);
+            replica_sequence         = other.replica_sequence;
+            input_waiter             = std::exchange(other.input_waiter, nullptr);
+            flush_waiter             = std::exchange(other.flush_waiter, nullptr);
+            connection_task          = std::move(other.connection_task);
             other.writing_registered = false;
         }
         return *this;
     }
 
-    auto client_connection::make(int target_fd, ip_address &&target_ip)
+    auto client_connection::make(int target_fd, peer_address &&target_peer)
         -> std::expected<client_connection, std::string>
     {
         if (target_fd < 0)
@@ -45,13 +67,7 @@ namespace oreore
             return std::unexpected("client_connection::make error: Invalid "
                                    "file descriptor.");
         }
-        if (!target_ip.get_raw().has_value()
-            || !target_ip.get_string().has_value())
-        {
-            return std::unexpected("client_connection::make error: Provided "
-                                   "ip_address is not fully initialized.");
-        }
-        return client_connection(target_fd, std::move(target_ip));
+        return client_connection(target_fd, std::move(target_peer));
     }
 
     auto client_connection::get_fd(void) const -> int
@@ -59,17 +75,22 @@ namespace oreore
         return current_fd.get();
     }
 
-    auto client_connection::get_ip_string(void) const -> std::string
+    auto client_connection::get_peer_string(void) const -> std::string
+    {
+        return current_peer_address.get_string();
+    }
+
+    auto client_connection::is_local_peer(void) const -> bool
     {
-        return current_ip_address.get_string().value_or("Unknown IP");
+        return current_peer_address.is_local();
     }
 
-    auto client_connection::get_read_buffer(void) -> std::string &
+    auto client_connection::get_read_buffer(void) -> pooled_string &
     {
         return read_buffer;
     }
 
-    auto client_connection::get_write_buffer(void) -> std::string &
+    auto client_connection::get_write_buffer(void) -> pooled_string &
     {
         return write_buffer;
     }
@@ -79,4 +100,70 @@ namespace oreore
         return writing_registered;
     }
 
+    auto client_connection::get_protocol_mode(void) const -> protocol_mode
+    {
+        return current_protocol_mode;
+    }
+
+    auto client_connection::set_protocol_mode(protocol_mode mode) -> void
+    {
+        current_protocol_mode = mode;
+    }
+
+    auto client_connection::get_compression_mode(void) const -> compression_mode
+    {
+        return current_compression_mode;
+    }
+
+    auto client_connection::set_compression_mode(compression_mode mode) -> void
+    {
+        current_compression_mode = mode;
+    }
+
+    auto client_connection::is_router_peer(void) const -> bool
+    {
+        return router_peer;
+    }
+
+    auto client_connection::set_router_peer(bool is_router) -> void
+    {
+        router_peer = is_router;
+    }
+
+    auto client_connection::is_traced(void) const -> bool
+    {
+        return traced;
+    }
+
+    auto client_connection::set_traced(bool sampled) -> void
+    {
+        traced = sampled;
+    }
+
+    auto client_connection::get_pending_batch(void) -> pending_batch &
+    {
+        return current_batch;
+    }
+
+    auto client_connection::get_replica_sequence(void)
+        -> std::optional<uintmax_t> &
+    {
+        return replica_sequence;
+    }
+
+    auto client_connection::get_input_waiter(void) -> std::coroutine_handle<> &
+    {
+        return input_waiter;
+    }
+
+    auto client_connection::get_flush_waiter(void) -> std::coroutine_handle<> &
+    {
+        return flush_waiter;
+    }
+
+    auto client_connection::get_task(void) -> task<> &
+    {
+        return connection_task;
+    }
+
 }
@@ -0,0 +1,439 @@
+#include <oreore/cluster.hpp>
+#include <oreore/message.hpp>
+#include <oreore/message_store.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <sys/socket.h>
+
+namespace oreore
+{
+    namespace
+    {
+        // FNV-1a, finished with the splitmix64 mixer so that short, similar
+        // keys (IP addresses) still spread over the whole ring.
+        auto hash_key(std::string_view key) -> uint64_t
+        {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (char character : key)
+            {
+                hash ^= static_cast<unsigned char>(character);
+                hash *= 0x100000001b3ULL;
+            }
+            hash ^= hash >> 30;
+            hash *= 0xbf58476d1ce4e5b9ULL;
+            hash ^= hash >> 27;
+            hash *= 0x94d049bb133111ebULL;
+            hash ^= hash >> 31;
+            return hash;
+        }
+
+        inline constexpr std::string_view MESSAGE_LINE_PREFIX = "ID: ";
+        inline constexpr std::string_view VERSION_LINE_PREFIX = "VERSION: ";
+    }
+
+    shard_ring::shard_ring(size_t shard_count)
+    {
+        points.reserve(shard_count * SHARD_RING_POINTS);
+        for (size_t shard = 0; shard < shard_count; ++shard)
+        {
+            for (size_t point = 0; point < SHARD_RING_POINTS; ++point)
+            {
+                points.emplace_back(
+                    hash_key(
+                        "shard-" + std::to_string(shard) + "-" + std::to_string(point)
+                    ),
+                    shard
+                );
+            }
+        }
+        std::sort(points.begin(), points.end());
+    }
+
+    auto shard_ring::owner(std::string_view key) const -> size_t
+    {
+        uint64_t hash     = hash_key(key);
+        auto     it_point = std::lower_bound(
+            points.begin(),
+            points.end(),
+            hash,
+            [](const auto &point, uint64_t value)
+            {
+                return point.first < value;
+            }
+        );
+        if (it_point == points.end())
+        {
+            it_point = points.begin();
+        }
+        return it_point->second;
+    }
+
+    auto cluster_secret_matches(std::string_view presented, std::string_view expected)
+        -> bool
+    {
+        if (expected.empty() || presented.size() != expected.size())
+        {
+            return false;
+        }
+        unsigned char difference = 0;
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            difference |= static_cast<unsigned char>(presented[i] ^ expected[i]);
+        }
+        return difference == 0;
+    }
+
+    auto format_shard_get(const message_filter &filter) -> std::string
+    {
+        std::string command = "GET";
+        if (filter.sender_ip)
+        {
+            command.append(" FROM ").append(*filter.sender_ip);
+        }
+        if (filter.reaction)
+        {
+            command.append(" REACTION ")
+                .append(filter.reaction->empty() ? "NONE" : *filter.reaction);
+        }
+        if (filter.after_id)
+        {
+            command.append(" AFTER ").append(std::to_string(*filter.after_id));
+        }
+        if (filter.limit != SIZE_MAX)
+        {
+            command.append(" LIMIT ").append(std::to_string(filter.limit));
+        }
+        // No board reaches this version, so the shard always renders.
+        command.append(" IFCHANGED ").append(std::to_string(UINTMAX_MAX));
+        return command;
+    }
+
+    shard_merge::shard_merge(size_t shard_count)
+        : pages(shard_count)
+        , merged_count(0)
+        , version_sum(0)
+        , every_board_empty(true)
+    {
+        heads.reserve(shard_count);
+    }
+
+    auto shard_merge::next_line(size_t shard) -> void
+    {
+        shard_page &page = pages[shard];
+        if (!page.rest.starts_with(MESSAGE_LINE_PREFIX))
+        {
+            page.rest  = {};
+            page.line  = {};
+            page.reply = std::string();
+            if (page.full)
+            {
+                starved.push_back(shard);
+            }
+            return;
+        }
+        size_t line_end = page.rest.find('\n');
+        line_end  = line_end == std::string_view::npos ? page.rest.size() : line_end + 1;
+        page.line = page.rest.substr(0, line_end);
+        page.rest.remove_prefix(line_end);
+
+        std::string_view digits = page.line.substr(MESSAGE_LINE_PREFIX.size());
+        digits = digits.substr(0, digits.find(','));
+        heads.emplace_back(parse_unsigned(digits).value_or(UINTMAX_MAX), shard);
+        std::push_heap(heads.begin(), heads.end(), std::greater<> {});
+    }
+
+    auto shard_merge::add_page(size_t shard, std::string reply, size_t requested)
+        -> std::expected<void, std::string>
+    {
+        if (reply.starts_with("ERR:"))
+        {
+            return std::unexpected(std::move(reply));
+        }
+        shard_page &page = pages[shard];
+        page.reply       = std::move(reply);
+
+        // A trailing "VERSION: <n>" line carries the shard's version.
+        std::string_view body(page.reply);
+        std::string_view lines     = body.substr(0, body.size() - body.ends_with('\n'));
+        size_t           last_line = lines.rfind('\n');
+        last_line = last_line == std::string_view::npos ? 0 : last_line + 1;
+        if (lines.substr(last_line).starts_with(VERSION_LINE_PREFIX))
+        {
+            if (!page.received)
+            {
+                auto version = parse_unsigned(
+                    lines.substr(last_line + VERSION_LINE_PREFIX.size())
+                );
+                version_sum += version.value_or(0);
+            }
+            body = body.substr(0, last_line);
+        }
+        if (!page.received && body != EMPTY_BOARD_REPLY)
+        {
+            every_board_empty = false;
+        }
+        page.received = true;
+
+        // Every line of a page is a message line ending in a newline.
+        size_t line_count = body.starts_with(MESSAGE_LINE_PREFIX)
+                              ? static_cast<size_t>(std::ranges::count(body, '\n'))
+                              : 0;
+        page.full = line_count == requested;
+        page.rest = body;
+        next_line(shard);
+        return {};
+    }
+
+    auto shard_merge::drain(std::string &out, size_t limit) -> std::vector<size_t>
+    {
+        while (merged_count < limit && starved.empty() && !heads.empty())
+        {
+            std::pop_heap(heads.begin(), heads.end(), std::greater<> {});
+            auto [line_id, shard] = heads.back();
+            heads.pop_back();
+
+            shard_page &page = pages[shard];
+            out.append(page.line);
+            page.last_id = line_id;
+            ++merged_count;
+            next_line(shard);
+        }
+        if (merged_count >= limit)
+        {
+            return {};
+        }
+        return std::exchange(starved, {});
+    }
+
+    auto shard_merge::resume_after(size_t shard) const -> std::optional<uintmax_t>
+    {
+        return pages[shard].last_id;
+    }
+
+    auto shard_merge::matches(void) const -> size_t
+    {
+        return merged_count;
+    }
+
+    auto shard_merge::version(void) const -> uintmax_t
+    {
+        return version_sum;
+    }
+
+    auto shard_merge::boards_empty(void) const -> bool
+    {
+        return every_board_empty;
+    }
+
+    shard_link::shard_link(remote_address address, std::string cluster_secret)
+        : node(std::move(address))
+        , secret(std::move(cluster_secret))
+        , connected(false)
+        , awaiting_handshake(false)
+        , next_request_id(0)
+    {
+    }
+
+    shard_link::shard_link(shard_link &&other) noexcept
+        : node(std::move(other.node))
+        , secret(std::move(other.secret))
+        , socket_fd(std::move(other.socket_fd))
+        , read_buffer(std::move(other.read_buffer))
+        , write_buffer(std::move(other.write_buffer))
+        , connected(other.connected)
+        , awaiting_handshake(other.awaiting_handshake)
+        , next_request_id(other.next_request_id)
+    {
+        other.connected = false;
+    }
+
+    auto shard_link::operator=(shard_link &&other) noexcept -> shard_link &
+    {
+        if (this != &other)
+        {
+            node               = std::move(other.node);
+            secret             = std::move(other.secret);
+            socket_fd          = std::move(other.socket_fd);
+            read_buffer        = std::move(other.read_buffer);
+            write_buffer       = std::move(other.write_buffer);
+            connected          = other.connected;
+            awaiting_handshake = other.awaiting_handshake;
+            next_request_id    = other.next_request_id;
+            other.connected    = false;
+        }
+
+        return *this;
+    }
+
+    auto shard_link::make(const std::string &address, const std::string &cluster_secret)
+        -> std::expected<shard_link, std::string>
+    {
+        auto parsed = parse_remote_address(address);
+        if (!parsed)
+        {
+            return std::unexpected("shard_link::make error: " + parsed.error());
+        }
+
+        return shard_link(std::move(*parsed), cluster_secret);
+    }
+
+    auto shard_link::start_connect(void) -> std::expected<void, std::string>
+    {
+        disconnect();
+
+        auto fd = start_outbound_connect(node);
+        if (!fd)
+        {
+            return std::unexpected("cluster: " + fd.error());
+        }
+
+        socket_fd          = std::move(*fd);
+        write_buffer       = std::string(BINARY_HANDSHAKE_LINE) + "\n";
+        awaiting_handshake = true;
+        // Nobody waits on the hello's reply; it only has to come first.
+        write_buffer.append(encode_binary_frame(
+            binary_opcode::router_hello,
+            binary_status::ok,
+            next_request_id++,
+            secret
+        ));
+        return {};
+    }
+
+    auto shard_link::finish_connect(void) -> std::expected<void, std::string>
+    {
+        if (auto result = check_outbound_connect(socket_fd.get()); !result)
+        {
+            return std::unexpected(
+                "cluster: " + result.error() + " (" + get_address() + ")"
+            );
+        }
+        connected = true;
+
+        return send_pending();
+    }
+
+    auto shard_link::disconnect(void) -> void
+    {
+        socket_fd = scoped_file_descriptor();
+        read_buffer.clear();
+        write_buffer.clear();
+        connected          = false;
+        awaiting_handshake = false;
+    }
+
+    auto shard_link::queue_request(std::string_view payload) -> uint32_t
+    {
+        uint32_t request_id = next_request_id++;
+        write_buffer.append(encode_binary_frame(
+            binary_opcode::routed,
+            binary_status::ok,
+            request_id,
+            payload
+        ));
+
+        return request_id;
+    }
+
+    auto shard_link::send_pending(void) -> std::expected<void, std::string>
+    {
+        size_t sent_total = 0;
+        while (connected && sent_total < write_buffer.size())
+        {
+            ssize_t bytes_sent = send(
+                socket_fd.get(),
+                write_buffer.data() + sent_total,
+                write_buffer.size() - sent_total,
+                MSG_NOSIGNAL
+            );
+            if (bytes_sent == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    break;
+                }
+                return std::unexpected(make_errno_message("cluster: send error"));
+            }
+            sent_total += bytes_sent;
+        }
+        write_buffer.erase(0, sent_total);
+
+        return {};
+    }
+
+    auto shard_link::receive(void) -> std::expected<void, std::string>
+    {
+        char buffer[BUFFER_SIZE];
+        while (true)
+        {
+            ssize_t bytes_received = recv(socket_fd.get(), buffer, sizeof(buffer), 0);
+            if (bytes_received > 0)
+            {
+                read_buffer.append(buffer, bytes_received);
+                continue;
+            }
+            if (bytes_received == 0)
+            {
+                return std::unexpected("cluster: shard closed the connection");
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return {};
+            }
+            return std::unexpected(make_errno_message("cluster: recv error"));
+        }
+    }
+
+    auto shard_link::take_reply(void)
+        -> std::expected<std::optional<shard_reply>, std::string>
+    {
+        if (awaiting_handshake)
+        {
+            size_t newline_pos = read_buffer.find('\n');
+            if (newline_pos == std::string::npos)
+            {
+                return std::nullopt;
+            }
+            // A shedding node refuses the handshake like any other command.
+            if (!read_buffer.starts_with("OK:"))
+            {
+                return std::unexpected(
+                    "cluster: handshake refused: " + read_buffer.substr(0, newline_pos)
+                );
+            }
+            read_buffer.erase(0, newline_pos + 1);
+            awaiting_handshake = false;
+        }
+
+        auto header = decode_binary_header(read_buffer);
+        if (!header
+            || read_buffer.size() < BINARY_HEADER_SIZE + header->payload_length)
+        {
+            return std::nullopt;
+        }
+
+        shard_reply reply {
+            header->request_id,
+            read_buffer.substr(BINARY_HEADER_SIZE, header->payload_length)
+        };
+        read_buffer.erase(0, BINARY_HEADER_SIZE + header->payload_length);
+        return reply;
+    }
+
+    auto shard_link::get_fd(void) const -> int
+    {
+        return socket_fd.get();
+    }
+
+    auto shard_link::is_connected(void) const -> bool
+    {
+        return connected;
+    }
+
+    auto shard_link::get_address(void) const -> std::string
+    {
+        return describe_remote_address(node);
+    }
+
+}
@@ -0,0 +1,86 @@
+#include <oreore/binary_protocol.hpp>
+#include <oreore/compression.hpp>
+
+#ifdef OREORE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace oreore
+{
+    namespace
+    {
+        // data is at most MAX_FRAME_RAW_LENGTH bytes.
+        auto append_stored_frame(std::string &out, std::string_view data) -> void
+        {
+            char header[COMPRESSED_HEADER_SIZE];
+            store_le32(header, 0);
+            store_le32(header + 4, static_cast<uint32_t>(data.size()));
+            out.append(header, sizeof(header));
+            out.append(data);
+        }
+
+#ifdef OREORE_HAVE_ZLIB
+        // data is at most MAX_FRAME_RAW_LENGTH bytes, so a compressed
+        // payload, kept only when shorter, fits the header too.
+        auto append_frame(std::string &out, std::string_view data, int level) -> void
+        {
+            if (data.size() < COMPRESSION_MIN_SIZE)
+            {
+                append_stored_frame(out, data);
+                return;
+            }
+
+            size_t frame_start       = out.size();
+            uLongf compressed_length = compressBound(data.size());
+            out.resize(frame_start + COMPRESSED_HEADER_SIZE + compressed_length);
+            char *payload = out.data() + frame_start + COMPRESSED_HEADER_SIZE;
+            int   rc      = compress2(
+                reinterpret_cast<Bytef *>(payload),
+                &compressed_length,
+                reinterpret_cast<const Bytef *>(data.data()),
+                data.size(),
+                level
+            );
+            // Incompressible input is cheaper to ship as-is.
+            if (rc != Z_OK || compressed_length >= data.size())
+            {
+                out.resize(frame_start);
+                append_stored_frame(out, data);
+                return;
+            }
+
+            out.resize(frame_start + COMPRESSED_HEADER_SIZE + compressed_length);
+            store_le32(out.data() + frame_start, static_cast<uint32_t>(compressed_length));
+            store_le32(out.data() + frame_start + 4, static_cast<uint32_t>(data.size()));
+        }
+#endif
+    }
+
+    auto compression_available(void) -> bool
+    {
+#ifdef OREORE_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    auto make_compressed_frame(std::string_view data, int level) -> std::string
+    {
+        std::string frames;
+        do
+        {
+            std::string_view chunk = data.substr(0, MAX_FRAME_RAW_LENGTH);
+            data.remove_prefix(chunk.size());
+#ifdef OREORE_HAVE_ZLIB
+            append_frame(frames, chunk, level);
+#else
+            (void)level;
+            append_stored_frame(frames, chunk);
+#endif
+        } while (!data.empty());
+
+        return frames;
+    }
+
+}
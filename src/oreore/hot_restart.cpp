@@ -0,0 +1,687 @@
+#include <oreore/binary_protocol.hpp>
+#include <oreore/hot_restart.hpp>
+#include <oreore/message.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace oreore
+{
+    namespace
+    {
+        inline constexpr size_t HANDOFF_HEADER_SIZE = 16;
+        // Where the state file holds the store's length.
+        inline constexpr off_t  STORE_LENGTH_OFFSET = sizeof(uint64_t);
+
+        auto append_u64(std::string &out, uint64_t value) -> void
+        {
+            char encoded[sizeof(uint64_t)];
+            store_le64(encoded, value);
+            out.append(encoded, sizeof(encoded));
+        }
+
+        auto append_bytes(std::string &out, std::string_view bytes) -> void
+        {
+            append_u64(out, bytes.size());
+            out.append(bytes);
+        }
+
+        // Cursor over the state blob; any overrun latches `ok` to false.
+        struct state_reader
+        {
+            std::string_view data;
+            bool             ok = true;
+
+            auto u64(void) -> uint64_t
+            {
+                if (data.size() < sizeof(uint64_t))
+                {
+                    ok = false;
+                    return 0;
+                }
+                uint64_t value = load_le64(data.data());
+                data.remove_prefix(sizeof(uint64_t));
+                return value;
+            }
+
+            auto bytes(void) -> std::string
+            {
+                uint64_t length = u64();
+                if (!ok || data.size() < length)
+                {
+                    ok = false;
+                    return {};
+                }
+                std::string value(data.substr(0, length));
+                data.remove_prefix(length);
+                return value;
+            }
+        };
+
+        auto make_unix_address(const std::string &path)
+            -> std::expected<sockaddr_un, std::string>
+        {
+            sockaddr_un address {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path))
+            {
+                return std::unexpected("hot restart: socket path too long: " + path);
+            }
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+            return address;
+        }
+
+        auto set_handoff_timeouts(int fd) -> void
+        {
+            timeval timeout {};
+            timeout.tv_sec = HANDOFF_TIMEOUT_SECONDS;
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        }
+
+        // Sends one message; false when a non-blocking socket is full (or a
+        // blocking one timed out).
+        auto send_with_fds(int socket_fd, std::string_view data, std::span<const int> fds)
+            -> std::expected<bool, std::string>
+        {
+            iovec  io { const_cast<char *>(data.data()), data.size() };
+            msghdr header {};
+            header.msg_iov    = &io;
+            header.msg_iovlen = 1;
+
+            std::vector<char> control;
+            if (!fds.empty())
+            {
+                control.resize(CMSG_SPACE(fds.size_bytes()));
+                header.msg_control    = control.data();
+                header.msg_controllen = control.size();
+                cmsghdr *cmsg         = CMSG_FIRSTHDR(&header);
+                cmsg->cmsg_level      = SOL_SOCKET;
+                cmsg->cmsg_type       = SCM_RIGHTS;
+                cmsg->cmsg_len        = CMSG_LEN(fds.size_bytes());
+                std::memcpy(CMSG_DATA(cmsg), fds.data(), fds.size_bytes());
+            }
+
+            ssize_t sent = sendmsg(socket_fd, &header, MSG_NOSIGNAL);
+            if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                return false;
+            }
+            if (sent != static_cast<ssize_t>(data.size()))
+            {
+                return std::unexpected(make_errno_message("hot restart: sendmsg failed"
+                ));
+            }
+            return true;
+        }
+
+        // Receives one message, appending any passed descriptors to fds;
+        // false when none is waiting (or a blocking socket timed out).
+        auto receive_with_fds(
+            int                                  socket_fd,
+            std::string                         &data,
+            std::vector<scoped_file_descriptor> &fds
+        ) -> std::expected<bool, std::string>
+        {
+            data.resize(HANDOFF_CHUNK_SIZE);
+            iovec  io { data.data(), data.size() };
+            msghdr header {};
+            header.msg_iov    = &io;
+            header.msg_iovlen = 1;
+
+            std::vector<char> control(
+                CMSG_SPACE(HANDOFF_FDS_PER_MESSAGE * sizeof(int))
+            );
+            header.msg_control    = control.data();
+            header.msg_controllen = control.size();
+
+            ssize_t received = recvmsg(socket_fd, &header, MSG_CMSG_CLOEXEC);
+            if (received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                return false;
+            }
+            if (received <= 0)
+            {
+                return std::unexpected(
+                    received == 0 ? std::string("hot restart: peer closed early")
+                                  : make_errno_message("hot restart: recvmsg failed")
+                );
+            }
+            data.resize(static_cast<size_t>(received));
+
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+                 cmsg          = CMSG_NXTHDR(&header, cmsg))
+            {
+                if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                {
+                    continue;
+                }
+                size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    int fd;
+                    std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                    fds.emplace_back(fd);
+                }
+            }
+            if (header.msg_flags & (MSG_TRUNC | MSG_CTRUNC))
+            {
+                return std::unexpected("hot restart: truncated handoff message");
+            }
+            return true;
+        }
+
+        // The new process's side blocks, with the socket's timeouts.
+        auto send_blocking(int socket_fd, std::string_view data)
+            -> std::expected<void, std::string>
+        {
+            auto sent = send_with_fds(socket_fd, data, {});
+            if (!sent)
+            {
+                return std::unexpected(sent.error());
+            }
+            if (!*sent)
+            {
+                return std::unexpected("hot restart: timed out sending to the old process");
+            }
+            return {};
+        }
+
+        auto receive_blocking(
+            int                                  socket_fd,
+            std::string                         &data,
+            std::vector<scoped_file_descriptor> &fds
+        ) -> std::expected<void, std::string>
+        {
+            auto received = receive_with_fds(socket_fd, data, fds);
+            if (!received)
+            {
+                return std::unexpected(received.error());
+            }
+            if (!*received)
+            {
+                return std::unexpected(
+                    "hot restart: timed out waiting for the old process"
+                );
+            }
+            return {};
+        }
+
+        auto serialize_client(std::string &out, client_connection &client) -> void
+        {
+            append_bytes(out, client.get_peer_string());
+            append_u64(out, static_cast<uint64_t>(client.get_protocol_mode()));
+            append_u64(out, static_cast<uint64_t>(client.get_compression_mode()));
+            append_u64(out, client.is_router_peer());
+            append_bytes(out, client.get_read_buffer());
+            append_bytes(out, client.get_write_buffer());
+
+            const auto &replica_sequence = client.get_replica_sequence();
+            append_u64(out, replica_sequence.has_value());
+            append_u64(out, replica_sequence.value_or(0));
+
+            const pending_batch &batch = client.get_pending_batch();
+            append_u64(out, static_cast<uint64_t>(batch.kind));
+            append_u64(out, batch.remaining);
+            append_bytes(out, batch.tag);
+            append_u64(out, batch.lines.size());
+            for (const auto &line : batch.lines)
+            {
+                append_bytes(out, line);
+            }
+        }
+
+        auto deserialize_client(state_reader &reader, scoped_file_descriptor &&fd)
+            -> std::expected<client_connection, std::string>
+        {
+            auto peer = peer_address::parse(reader.bytes());
+            if (!peer)
+            {
+                return std::unexpected(peer.error());
+            }
+            auto client = client_connection::make(fd.release(), std::move(*peer));
+            if (!client)
+            {
+                return std::unexpected(client.error());
+            }
+
+            client->set_protocol_mode(static_cast<protocol_mode>(reader.u64()));
+            client->set_compression_mode(static_cast<compression_mode>(reader.u64()
+            ));
+            client->set_router_peer(reader.u64() != 0);
+            client->get_read_buffer()  = reader.bytes();
+            client->get_write_buffer() = reader.bytes();
+
+            bool     has_replica_sequence = reader.u64() != 0;
+            uint64_t replica_sequence     = reader.u64();
+            if (has_replica_sequence)
+            {
+                client->get_replica_sequence() = replica_sequence;
+            }
+
+            pending_batch &batch = client->get_pending_batch();
+            batch.kind           = static_cast<batch_kind>(reader.u64());
+            batch.remaining      = reader.u64();
+            batch.tag            = reader.bytes();
+            uint64_t line_count  = reader.u64();
+            for (uint64_t i = 0; reader.ok && i < line_count; ++i)
+            {
+                batch.lines.push_back(reader.bytes());
+            }
+
+            if (!reader.ok)
+            {
+                return std::unexpected("hot restart: truncated client state");
+            }
+            return std::move(client.value());
+        }
+    }
+
+    handoff_state_file::handoff_state_file(
+        scoped_file_descriptor &&file,
+        size_t                   listener_count
+    )
+        : fd(std::move(file))
+        , written(0)
+        , store_length(0)
+    {
+        append_u64(pending, listener_count);
+        append_u64(pending, 0); // the store's length, filled in by finish()
+    }
+
+    auto handoff_state_file::make(size_t listener_count)
+        -> std::expected<handoff_state_file, std::string>
+    {
+        scoped_file_descriptor file(memfd_create("oreore-handoff", MFD_CLOEXEC));
+        if (file.get() == -1)
+        {
+            return std::unexpected(make_errno_message(
+                "hot restart: memfd_create() failed"
+            ));
+        }
+        return handoff_state_file(std::move(file), listener_count);
+    }
+
+    auto handoff_state_file::flush(bool force) -> std::expected<void, std::string>
+    {
+        if (!force && pending.size() < HANDOFF_CHUNK_SIZE)
+        {
+            return {};
+        }
+
+        std::string_view rest(pending);
+        while (!rest.empty())
+        {
+            ssize_t count = ::write(fd.get(), rest.data(), rest.size());
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return std::unexpected(make_errno_message(
+                    "hot restart: writing the state file failed"
+                ));
+            }
+            rest.remove_prefix(static_cast<size_t>(count));
+            written += static_cast<uint64_t>(count);
+        }
+        pending.clear();
+        return {};
+    }
+
+    auto handoff_state_file::append_store(std::string_view events)
+        -> std::expected<void, std::string>
+    {
+        pending.append(events);
+        store_length += events.size();
+        return flush(false);
+    }
+
+    auto handoff_state_file::append_client(client_connection &client)
+        -> std::expected<void, std::string>
+    {
+        serialize_client(pending, client);
+        return flush(false);
+    }
+
+    auto handoff_state_file::finish(void) -> std::expected<void, std::string>
+    {
+        if (auto result = flush(true); !result)
+        {
+            return result;
+        }
+
+        char encoded[sizeof(uint64_t)];
+        store_le64(encoded, store_length);
+        if (pwrite(fd.get(), encoded, sizeof(encoded), STORE_LENGTH_OFFSET)
+            != static_cast<ssize_t>(sizeof(encoded)))
+        {
+            return std::unexpected(make_errno_message(
+                "hot restart: writing the state file failed"
+            ));
+        }
+        return {};
+    }
+
+    auto handoff_state_file::get_fd(void) const -> int
+    {
+        return fd.get();
+    }
+
+    auto handoff_state_file::size(void) const -> uint64_t
+    {
+        return written + pending.size();
+    }
+
+    auto make_handoff_listener(const std::string &path)
+        -> std::expected<scoped_file_descriptor, std::string>
+    {
+        auto address = make_unix_address(path);
+        if (!address)
+        {
+            return std::unexpected(address.error());
+        }
+
+        scoped_file_descriptor fd(
+            socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)
+        );
+        if (fd.get() == -1)
+        {
+            return std::unexpected(make_errno_message("hot restart: socket() failed"
+            ));
+        }
+        ::unlink(path.c_str());
+        if (bind(fd.get(), (struct sockaddr *)&*address, sizeof(*address)) < 0)
+        {
+            return std::unexpected(make_errno_message(
+                "hot restart: bind(" + path + ") failed"
+            ));
+        }
+        if (listen(fd.get(), 1) < 0)
+        {
+            return std::unexpected(make_errno_message("hot restart: listen() failed"
+            ));
+        }
+
+        return fd;
+    }
+
+    handoff_peer::handoff_peer(scoped_file_descriptor &&peer)
+        : fd(std::move(peer))
+        , phase(handoff_phase::request)
+        , with_clients(false)
+        , deadline(
+              std::chrono::steady_clock::now()
+              + std::chrono::seconds(HANDOFF_TIMEOUT_SECONDS)
+          )
+    {
+    }
+
+    auto handoff_peer::receive_request(void) -> std::expected<bool, std::string>
+    {
+        std::string                         request;
+        std::vector<scoped_file_descriptor> unexpected_fds;
+        auto received = receive_with_fds(fd.get(), request, unexpected_fds);
+        if (!received || !*received)
+        {
+            return received;
+        }
+
+        if (request != TAKEOVER_CLIENTS_REQUEST && request != TAKEOVER_REQUEST)
+        {
+            return std::unexpected("hot restart: unknown request '" + request + "'");
+        }
+        with_clients = request == TAKEOVER_CLIENTS_REQUEST;
+        phase        = handoff_phase::quiescing;
+        deadline     = std::chrono::steady_clock::now()
+                 + std::chrono::seconds(HANDOFF_TRANSFER_TIMEOUT_SECONDS);
+        return true;
+    }
+
+    auto handoff_peer::start_sending(
+        std::span<const scoped_file_descriptor> listeners,
+        handoff_state_file                    &&state_file,
+        std::span<client_connection *const>     clients
+    ) -> void
+    {
+        state = std::move(state_file);
+
+        outgoing_message header { std::string(HANDOFF_HEADER_SIZE, '\0'), {} };
+        store_le32(header.data.data(), HANDOFF_MAGIC);
+        store_le32(
+            header.data.data() + 4,
+            static_cast<uint32_t>(1 + listeners.size() + clients.size())
+        );
+        store_le64(header.data.data() + 8, state->size());
+        header.fds.push_back(state->get_fd());
+        for (const scoped_file_descriptor &listener : listeners)
+        {
+            header.fds.push_back(listener.get());
+        }
+        outbox.push_back(std::move(header));
+
+        for (size_t queued = 0; queued < clients.size();
+             queued       += HANDOFF_FDS_PER_MESSAGE)
+        {
+            outgoing_message group { "F", {} };
+            size_t count = std::min(HANDOFF_FDS_PER_MESSAGE, clients.size() - queued);
+            for (size_t i = queued; i < queued + count; ++i)
+            {
+                group.fds.push_back(clients[i]->get_fd());
+            }
+            outbox.push_back(std::move(group));
+        }
+        phase = handoff_phase::sending;
+    }
+
+    auto handoff_peer::send_pending(void) -> std::expected<void, std::string>
+    {
+        while (!outbox.empty())
+        {
+            auto sent = send_with_fds(fd.get(), outbox.front().data, outbox.front().fds);
+            if (!sent)
+            {
+                return std::unexpected(sent.error());
+            }
+            if (!*sent)
+            {
+                return {};
+            }
+            outbox.pop_front();
+        }
+        phase = handoff_phase::awaiting_ready;
+        state.reset();
+        return {};
+    }
+
+    auto handoff_peer::receive_ready(void) -> std::expected<bool, std::string>
+    {
+        std::string                         message;
+        std::vector<scoped_file_descriptor> unexpected_fds;
+        auto received = receive_with_fds(fd.get(), message, unexpected_fds);
+        if (!received || !*received)
+        {
+            return received;
+        }
+        if (message != TAKEOVER_READY)
+        {
+            return std::unexpected("hot restart: expected READY, got '" + message + "'");
+        }
+
+        auto sent = send_with_fds(fd.get(), TAKEOVER_RELEASED, {});
+        if (!sent)
+        {
+            return std::unexpected(sent.error());
+        }
+        if (!*sent)
+        {
+            return std::unexpected("hot restart: could not send RELEASED");
+        }
+        phase = handoff_phase::released;
+        return true;
+    }
+
+    auto handoff_peer::get_fd(void) const -> int
+    {
+        return fd.get();
+    }
+
+    auto handoff_peer::get_phase(void) const -> handoff_phase
+    {
+        return phase;
+    }
+
+    auto handoff_peer::wants_clients(void) const -> bool
+    {
+        return with_clients;
+    }
+
+    auto handoff_peer::has_expired(std::chrono::steady_clock::time_point now) const
+        -> bool
+    {
+        return now >= deadline;
+    }
+
+    auto receive_handoff(const std::string &path, bool with_clients)
+        -> std::expected<handoff_state, std::string>
+    {
+        auto address = make_unix_address(path);
+        if (!address)
+        {
+            return std::unexpected(address.error());
+        }
+
+        scoped_file_descriptor peer(socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+        if (peer.get() == -1)
+        {
+            return std::unexpected(make_errno_message("hot restart: socket() failed"
+            ));
+        }
+        set_handoff_timeouts(peer.get());
+        if (connect(peer.get(), (struct sockaddr *)&*address, sizeof(*address)) < 0)
+        {
+            return std::unexpected(make_errno_message(
+                "hot restart: connect(" + path + ") failed"
+            ));
+        }
+
+        std::string_view request
+            = with_clients ? TAKEOVER_CLIENTS_REQUEST : TAKEOVER_REQUEST;
+        if (auto result = send_blocking(peer.get(), request); !result)
+        {
+            return std::unexpected(result.error());
+        }
+
+        std::string                         message;
+        std::vector<scoped_file_descriptor> fds;
+        if (auto result = receive_blocking(peer.get(), message, fds); !result)
+        {
+            return std::unexpected(result.error());
+        }
+        if (message.size() != HANDOFF_HEADER_SIZE
+            || load_le32(message.data()) != HANDOFF_MAGIC || fds.empty())
+        {
+            return std::unexpected("hot restart: malformed handoff header");
+        }
+        uint32_t fd_count     = load_le32(message.data() + 4);
+        uint64_t state_length = load_le64(message.data() + 8);
+
+        while (fds.size() < fd_count)
+        {
+            if (auto result = receive_blocking(peer.get(), message, fds); !result)
+            {
+                return std::unexpected(result.error());
+            }
+        }
+
+        // The state file comes first, ahead of the listeners.
+        const scoped_file_descriptor &state_file = fds.front();
+        struct stat                   state_status {};
+        if (fstat(state_file.get(), &state_status) < 0
+            || static_cast<uint64_t>(state_status.st_size) != state_length)
+        {
+            return std::unexpected("hot restart: state file does not match header");
+        }
+        std::string state(state_length, '\0');
+        for (size_t loaded = 0; loaded < state.size();)
+        {
+            ssize_t count = pread(
+                state_file.get(),
+                state.data() + loaded,
+                state.size() - loaded,
+                static_cast<off_t>(loaded)
+            );
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return std::unexpected(
+                    count == 0 ? std::string("hot restart: state file truncated")
+                               : make_errno_message(
+                                     "hot restart: reading the state file failed"
+                                 )
+                );
+            }
+            loaded += static_cast<size_t>(count);
+        }
+
+        handoff_state handoff;
+        state_reader  reader { state };
+        uint64_t      listener_count = reader.u64();
+        if (!reader.ok || listener_count == 0 || listener_count >= fds.size())
+        {
+            return std::unexpected("hot restart: malformed listener count");
+        }
+        for (size_t i = 1; i <= listener_count; ++i)
+        {
+            handoff.listeners.push_back(std::move(fds[i]));
+        }
+
+        handoff.store_snapshot = reader.bytes();
+        for (size_t i = 1 + listener_count; i < fds.size(); ++i)
+        {
+            auto client = deserialize_client(reader, std::move(fds[i]));
+            if (!client)
+            {
+                return std::unexpected(client.error());
+            }
+            handoff.clients.push_back(std::move(client.value()));
+        }
+        if (!reader.ok)
+        {
+            return std::unexpected("hot restart: truncated handoff state");
+        }
+
+        handoff.peer = std::move(peer);
+        return handoff;
+    }
+
+    auto confirm_takeover(int peer_fd) -> std::expected<void, std::string>
+    {
+        if (auto result = send_blocking(peer_fd, TAKEOVER_READY); !result)
+        {
+            return result;
+        }
+
+        std::string                         reply;
+        std::vector<scoped_file_descriptor> unexpected_fds;
+        if (auto result = receive_blocking(peer_fd, reply, unexpected_fds); !result)
+        {
+            return result;
+        }
+        if (reply != TAKEOVER_RELEASED)
+        {
+            return std::unexpected("hot restart: expected RELEASED, got '" + reply + "'");
+        }
+        return {};
+    }
+
+}
@@ -26,24 +26,6 @@ namespace oreore
 
     ip_address::ip_address(uint32_t addr_raw) : optional_address_raw(addr_raw)
     {
-        auto convert_to_string =
-            [](uint32_t input_address_raw) -> std::optional<std::string>
-        {
-            in_addr addr_in;
-            addr_in.s_addr = htonl(input_address_raw);
-            char buffer[INET_ADDRSTRLEN];
-            if (inet_ntop(AF_INET, &addr_in, buffer, sizeof(buffer)) != nullptr)
-            {
-                return std::string(buffer);
-            }
-
-            return std::nullopt;
-        };
-
-        if (optional_address_raw)
-        {
-            optional_address_string = convert_to_string(*optional_address_raw);
-        }
     }
 
     ip_address::ip_address(ip_address &&other) noexcept
@@ -92,21 +74,36 @@ namespace oreore
     auto ip_address::make(uint32_t address_value)
         -> std::expected<ip_address, std::string>
     {
-        ip_address instance(address_value);
-        if (!instance.optional_address_string.has_value()
-            || !instance.optional_address_raw.has_value())
-        {
-            return std::unexpected(
-                "ip_address::make error: Failed to convert raw IP or invalid "
-                "value: "
-                + std::to_string(address_value)
-            );
-        }
-        return instance;
+        // Every 32-bit value is an IPv4 address.
+        return ip_address(address_value);
     }
 
     auto ip_address::get_string(void) const -> const std::optional<std::string> &
     {
+        if (!optional_address_string && optional_address_raw)
+        {
+            // Same text as inet_ntop, without the library call.
+            char  buffer[INET_ADDRSTRLEN];
+            char *cursor = buffer;
+            for (int shift = 24; shift >= 0; shift -= 8)
+            {
+                unsigned octet = (*optional_address_raw >> shift) & 0xFF;
+                if (octet >= 100)
+                {
+                    *cursor++ = static_cast<char>('0' + octet / 100);
+                }
+                if (octet >= 10)
+                {
+                    *cursor++ = static_cast<char>('0' + octet / 10 % 10);
+                }
+                *cursor++ = static_cast<char>('0' + octet % 10);
+                if (shift != 0)
+                {
+                    *cursor++ = '.';
+                }
+            }
+            optional_address_string.emplace(buffer, cursor);
+        }
         return optional_address_string;
     }
 
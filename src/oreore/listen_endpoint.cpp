@@ -0,0 +1,146 @@
+#include <oreore/listen_endpoint.hpp>
+#include <oreore/message.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace oreore
+{
+    namespace
+    {
+        inline constexpr const char TCP_PREFIX[]  = "tcp:";
+        inline constexpr const char UNIX_PREFIX[] = "unix:";
+
+        auto make_unix_listening_socket(const listen_endpoint &endpoint, int backlog)
+            -> std::expected<scoped_file_descriptor, std::string>
+        {
+            sockaddr_un address {};
+            address.sun_family = AF_UNIX;
+            // Abstract names start with a NUL byte and are not terminated;
+            // the address length alone delimits them.
+            size_t name_offset
+                = endpoint.kind == endpoint_kind::unix_abstract ? 1 : 0;
+            if (endpoint.path.empty()
+                || name_offset + endpoint.path.size() >= sizeof(address.sun_path))
+            {
+                return std::unexpected(
+                    "unix socket name is empty or too long: " + endpoint.path
+                );
+            }
+            std::memcpy(
+                address.sun_path + name_offset,
+                endpoint.path.data(),
+                endpoint.path.size()
+            );
+            socklen_t address_length = static_cast<socklen_t>(
+                offsetof(sockaddr_un, sun_path) + name_offset + endpoint.path.size()
+                + (name_offset == 0 ? 1 : 0)
+            );
+
+            scoped_file_descriptor fd(
+                socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)
+            );
+            if (fd.get() == -1)
+            {
+                return std::unexpected(make_errno_message("socket() failed"));
+            }
+
+            if (endpoint.kind == endpoint_kind::unix_path)
+            {
+                // Only clear away sockets; never delete a regular file.
+                struct stat existing {};
+                if (lstat(endpoint.path.c_str(), &existing) == 0
+                    && S_ISSOCK(existing.st_mode))
+                {
+                    ::unlink(endpoint.path.c_str());
+                }
+            }
+            if (bind(fd.get(), (struct sockaddr *)&address, address_length) < 0)
+            {
+                return std::unexpected(make_errno_message(
+                    "bind(" + describe_listen_endpoint(endpoint) + ") failed"
+                ));
+            }
+            if (listen(fd.get(), backlog) < 0)
+            {
+                return std::unexpected(make_errno_message("listen() failed"));
+            }
+
+            return fd;
+        }
+    }
+
+    auto parse_listen_endpoint(const std::string &specification)
+        -> std::expected<listen_endpoint, std::string>
+    {
+        listen_endpoint  endpoint;
+        std::string_view rest(specification);
+        if (rest.starts_with(UNIX_PREFIX))
+        {
+            rest.remove_prefix(sizeof(UNIX_PREFIX) - 1);
+            endpoint.kind = endpoint_kind::unix_path;
+            if (rest.starts_with('@'))
+            {
+                rest.remove_prefix(1);
+                endpoint.kind = endpoint_kind::unix_abstract;
+            }
+            if (rest.empty())
+            {
+                return std::unexpected(
+                    "Missing socket name in endpoint '" + specification + "'."
+                );
+            }
+            endpoint.path = std::string(rest);
+            return endpoint;
+        }
+
+        if (rest.starts_with(TCP_PREFIX))
+        {
+            rest.remove_prefix(sizeof(TCP_PREFIX) - 1);
+        }
+        auto port = parse_unsigned(rest);
+        if (!port || *port > UINT16_MAX)
+        {
+            return std::unexpected(
+                "Invalid endpoint '" + specification
+                + "'. Use <port>, tcp:<port>, unix:<path> or unix:@<name>."
+            );
+        }
+        endpoint.kind = endpoint_kind::tcp;
+        endpoint.port = static_cast<uint16_t>(*port);
+        return endpoint;
+    }
+
+    auto describe_listen_endpoint(const listen_endpoint &endpoint) -> std::string
+    {
+        switch (endpoint.kind)
+        {
+            case endpoint_kind::tcp:
+                return TCP_PREFIX + std::to_string(endpoint.port);
+            case endpoint_kind::unix_path:
+                return UNIX_PREFIX + endpoint.path;
+            case endpoint_kind::unix_abstract:
+                return std::string(UNIX_PREFIX) + "@" + endpoint.path;
+        }
+        return "unknown";
+    }
+
+    auto make_listening_socket(
+        const listen_endpoint &endpoint,
+        int                    backlog,
+        bool                   reuse_port,
+        latency_profile        profile
+    ) -> std::expected<scoped_file_descriptor, std::string>
+    {
+        if (endpoint.kind == endpoint_kind::tcp)
+        {
+            return make_listening_socket(endpoint.port, backlog, reuse_port, profile);
+        }
+        return make_unix_listening_socket(endpoint, backlog);
+    }
+
+}
@@ -1,10 +1,38 @@
 #include <oreore/message.hpp>
 
 #include <cerrno>
+#include <charconv>
 #include <cstring>
 
 namespace oreore
 {
+    auto reaction_name(reaction_kind kind) -> std::string_view
+    {
+        switch (kind)
+        {
+            case reaction_kind::happy:
+                return "HAPPY";
+            case reaction_kind::sad:
+                return "SAD";
+            case reaction_kind::none:
+                break;
+        }
+        return "";
+    }
+
+    auto parse_reaction(std::string_view name) -> reaction_kind
+    {
+        if (name == "HAPPY")
+        {
+            return reaction_kind::happy;
+        }
+        if (name == "SAD")
+        {
+            return reaction_kind::sad;
+        }
+        return reaction_kind::none;
+    }
+
     auto make_errno_message(const std::string &base_message) -> std::string
     {
         return base_message + ": " + strerror(errno);
@@ -22,4 +50,16 @@ namespace oreore
 
         return str.substr(first, last - first + 1);
     }
+
+    auto parse_unsigned(std::string_view str) -> std::optional<uintmax_t>
+    {
+        uintmax_t value;
+        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+        if (str.empty() || ec != std::errc() || ptr != str.data() + str.size())
+        {
+            return std::nullopt;
+        }
+
+        return value;
+    }
 }
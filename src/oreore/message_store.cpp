@@ -0,0 +1,569 @@
+#include <oreore/cluster.hpp>
+#include <oreore/message_store.hpp>
+#include <oreore/probes.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ranges>
+
+namespace oreore
+{
+    namespace
+    {
+        inline constexpr size_t TRIGRAM_LENGTH = 3;
+
+        // Slot in reaction_index: none, HAPPY, SAD.
+        auto reaction_slot(reaction_kind reaction) -> size_t
+        {
+            return static_cast<size_t>(reaction);
+        }
+
+        auto pack_trigram(const char *text) -> uint32_t
+        {
+            const auto *bytes = reinterpret_cast<const unsigned char *>(text);
+            return (static_cast<uint32_t>(bytes[0]) << 16)
+                 | (static_cast<uint32_t>(bytes[1]) << 8)
+                 | static_cast<uint32_t>(bytes[2]);
+        }
+
+        // glibc's memmem is vectorized, which keeps candidate verification
+        // cheap even for long messages.
+        auto contains(const std::string &haystack, std::string_view needle)
+            -> bool
+        {
+            return ::memmem(
+                       haystack.data(),
+                       haystack.size(),
+                       needle.data(),
+                       needle.size()
+                   )
+                != nullptr;
+        }
+
+        auto append_rendered(std::string &out, const message &msg) -> void
+        {
+            out.append("ID: ").append(std::to_string(msg.id));
+            out.append(", From: ").append(msg.sender_ip);
+            out.append(", Reaction: [")
+                .append(reaction_name(msg.reaction.load(std::memory_order_relaxed)))
+                .append("]");
+            out.append(", Happy: ")
+                .append(std::to_string(msg.happy_count.load(std::memory_order_relaxed)));
+            out.append(", Sad: ")
+                .append(std::to_string(msg.sad_count.load(std::memory_order_relaxed)));
+            out.append(", Msg: \"").append(msg.text).append("\"\n");
+        }
+    }
+
+    message_snapshot::message_snapshot(void)
+        : first(0)
+        , last(0)
+        , use_positions(false)
+        , empty_reply(NO_MATCH_REPLY)
+        , not_modified(false)
+    {
+    }
+
+    auto message_snapshot::size(void) const -> size_t
+    {
+        return use_positions ? positions.size() : last - first;
+    }
+
+    auto message_snapshot::render(void) const -> std::string
+    {
+        if (not_modified)
+        {
+            return "NOT MODIFIED: " + std::to_string(*version) + "\n";
+        }
+        if (size() == 0)
+        {
+            std::string rendered(empty_reply);
+            append_version(rendered);
+            return rendered;
+        }
+
+        auto slot = [this](size_t position) -> const message &
+        {
+            return segments[position / MESSAGE_SEGMENT_SIZE]
+                ->slots[position % MESSAGE_SEGMENT_SIZE];
+        };
+        std::string rendered;
+        if (use_positions)
+        {
+            for (size_t position : positions)
+            {
+                append_rendered(rendered, slot(position));
+            }
+        }
+        else
+        {
+            for (size_t position = first; position < last; ++position)
+            {
+                append_rendered(rendered, slot(position));
+            }
+        }
+        append_version(rendered);
+
+        return rendered;
+    }
+
+    auto message_snapshot::append_version(std::string &rendered) const -> void
+    {
+        if (version)
+        {
+            rendered += "VERSION: ";
+            rendered += std::to_string(*version);
+            rendered += '\n';
+        }
+    }
+
+    message_store::message_store(void)
+        : message_count(0)
+        , next_message_id(0)
+        , id_stride(1)
+    {
+    }
+
+    message_store::message_store(size_t shard_index)
+        : message_count(0)
+        , next_message_id(shard_index)
+        , id_stride(MAX_SHARDS)
+    {
+    }
+
+    message_store::message_store(message_store &&other) noexcept
+        : messages(std::move(other.messages))
+        , message_count(other.message_count)
+        , next_message_id(other.next_message_id)
+        , id_stride(other.id_stride)
+        , trigram_index(std::move(other.trigram_index))
+        , sender_index(std::move(other.sender_index))
+        , reaction_index(std::move(other.reaction_index))
+        , event_log(std::move(other.event_log))
+    {
+        // messages_mutex is default-initialized in the new object
+        other.message_count   = 0;
+        other.next_message_id = 0;
+    }
+
+    auto message_store::operator=(message_store &&other) noexcept
+        -> message_store &
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        std::lock_guard<std::mutex> lock_this(messages_mutex);
+        messages              = std::move(other.messages);
+        message_count         = other.message_count;
+        next_message_id       = other.next_message_id;
+        id_stride             = other.id_stride;
+        trigram_index         = std::move(other.trigram_index);
+        sender_index          = std::move(other.sender_index);
+        reaction_index        = std::move(other.reaction_index);
+        event_log             = std::move(other.event_log);
+        other.message_count   = 0;
+        other.next_message_id = 0;
+
+        return *this;
+    }
+
+    auto message_store::lock(void) -> std::unique_lock<std::mutex>
+    {
+        OREORE_PROBE0(lock__acquire);
+        std::unique_lock<std::mutex> held(messages_mutex);
+        OREORE_PROBE0(lock__acquired);
+        return held;
+    }
+
+    auto message_store::at(size_t position) -> message &
+    {
+        return messages[position / MESSAGE_SEGMENT_SIZE]
+            ->slots[position % MESSAGE_SEGMENT_SIZE];
+    }
+
+    auto message_store::at(size_t position) const -> const message &
+    {
+        return messages[position / MESSAGE_SEGMENT_SIZE]
+            ->slots[position % MESSAGE_SEGMENT_SIZE];
+    }
+
+    auto message_store::find(uintmax_t message_id) const -> std::optional<size_t>
+    {
+        // IDs are handed out in increasing order, so positions stay sorted.
+        auto positions = std::views::iota(size_t { 0 }, message_count);
+        auto it_pos    = std::ranges::partition_point(
+            positions,
+            [this, message_id](size_t position)
+            {
+                return at(position).id < message_id;
+            }
+        );
+        if (it_pos == positions.end() || at(*it_pos).id != message_id)
+        {
+            return std::nullopt;
+        }
+
+        return *it_pos;
+    }
+
+    auto message_store::append(
+        uintmax_t          id,
+        std::string        text,
+        const std::string &sender_ip
+    ) -> void
+    {
+        size_t position = message_count;
+        if (position % MESSAGE_SEGMENT_SIZE == 0)
+        {
+            messages.push_back(std::make_shared<message_segment>());
+        }
+        message &slot  = at(position);
+        slot.id        = id;
+        slot.text      = std::move(text);
+        slot.sender_ip = sender_ip;
+        ++message_count;
+
+        index_text(position);
+        sender_index[sender_ip].push_back(position);
+        auto &reaction_positions = reaction_index[reaction_slot(reaction_kind::none)];
+        reaction_positions.insert(reaction_positions.end(), position);
+        event_log.push_back({ replication_event_kind::post, position });
+    }
+
+    auto message_store::index_text(size_t position) -> void
+    {
+        const std::string &text = at(position).text;
+        for (size_t i = 0; i + TRIGRAM_LENGTH <= text.size(); ++i)
+        {
+            auto &postings = trigram_index[pack_trigram(text.data() + i)];
+            // Repeated trigrams within one message only need one posting.
+            if (postings.empty() || postings.back() != position)
+            {
+                postings.push_back(position);
+            }
+        }
+    }
+
+    auto message_store::post(std::string text, const std::string &sender_ip)
+        -> uintmax_t
+    {
+        uintmax_t current_id  = next_message_id;
+        next_message_id      += id_stride;
+        append(current_id, std::move(text), sender_ip);
+
+        return current_id;
+    }
+
+    auto message_store::post_batch(
+        std::span<const std::string> texts,
+        const std::string           &sender_ip
+    ) -> uintmax_t
+    {
+        uintmax_t first_id  = next_message_id;
+        next_message_id    += texts.size() * id_stride;
+
+        for (size_t i = 0; i < texts.size(); ++i)
+        {
+            append(first_id + i * id_stride, texts[i], sender_ip);
+        }
+
+        return first_id;
+    }
+
+    auto message_store::react(uintmax_t message_id, const std::string &reaction)
+        -> std::expected<void, std::string>
+    {
+        std::optional<size_t> position = find(message_id);
+        if (!position)
+        {
+            return std::unexpected(
+                "ERR: Message ID " + std::to_string(message_id) + " not found.\n"
+            );
+        }
+        message      &target = at(*position);
+        reaction_kind kind   = parse_reaction(reaction);
+        reaction_index[reaction_slot(target.reaction.load(std::memory_order_relaxed))]
+            .erase(*position);
+        reaction_index[reaction_slot(kind)].insert(*position);
+        target.reaction.store(kind, std::memory_order_relaxed);
+
+        // Only the lock holder writes, so a plain load and store suffices.
+        std::atomic<uint64_t> &count
+            = kind == reaction_kind::happy ? target.happy_count : target.sad_count;
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        event_log.push_back(
+            { kind == reaction_kind::happy ? replication_event_kind::happy
+                                           : replication_event_kind::sad,
+              *position }
+        );
+
+        return {};
+    }
+
+    auto message_store::event_count(void) const -> uintmax_t
+    {
+        return event_log.size();
+    }
+
+    auto message_store::get_id_stride(void) const -> uintmax_t
+    {
+        return id_stride;
+    }
+
+    auto message_store::format_events(
+        uintmax_t    from_sequence,
+        size_t       max_bytes,
+        std::string &out
+    ) const -> uintmax_t
+    {
+        size_t    start_size = out.size();
+        uintmax_t sequence   = from_sequence;
+        while (sequence < event_log.size() && out.size() - start_size < max_bytes)
+        {
+            const logged_event &event    = event_log[sequence];
+            const message      &msg_item = at(event.position);
+            out.append(format_replication_event(
+                sequence,
+                event.kind,
+                msg_item.id,
+                msg_item.sender_ip,
+                msg_item.text
+            ));
+            ++sequence;
+        }
+
+        return sequence;
+    }
+
+    auto message_store::apply(const replication_event &event)
+        -> std::expected<void, std::string>
+    {
+        if (event.sequence < event_log.size())
+        {
+            return {};
+        }
+        if (event.sequence > event_log.size())
+        {
+            return std::unexpected(
+                "replication: gap before sequence " + std::to_string(event.sequence)
+            );
+        }
+
+        switch (event.kind)
+        {
+            case replication_event_kind::post:
+                if (event.message_id < next_message_id)
+                {
+                    return std::unexpected(
+                        "replication: message ID "
+                        + std::to_string(event.message_id) + " out of order"
+                    );
+                }
+                next_message_id = event.message_id + id_stride;
+                append(event.message_id, event.text, event.sender_ip);
+                return {};
+
+            case replication_event_kind::happy:
+                return react(event.message_id, "HAPPY");
+
+            case replication_event_kind::sad:
+                return react(event.message_id, "SAD");
+        }
+
+        return std::unexpected("replication: unknown event kind");
+    }
+
+    auto message_store::first_position_after(std::optional<uintmax_t> after_id
+    ) const -> size_t
+    {
+        if (!after_id)
+        {
+            return 0;
+        }
+        auto positions = std::views::iota(size_t { 0 }, message_count);
+        return *std::ranges::partition_point(
+            positions,
+            [this, after_id](size_t position)
+            {
+                return at(position).id <= *after_id;
+            }
+        );
+    }
+
+    auto message_store::snapshot(const message_filter &filter) const
+        -> message_snapshot
+    {
+        message_snapshot pinned;
+        if (filter.if_changed_since)
+        {
+            // Checked first so an idle poll pins nothing.
+            pinned.version      = event_log.size();
+            pinned.not_modified = *filter.if_changed_since == *pinned.version;
+            if (pinned.not_modified)
+            {
+                return pinned;
+            }
+        }
+        pinned.segments = messages;
+
+        bool unfiltered = !filter.sender_ip && !filter.reaction;
+        if (message_count == 0 && unfiltered)
+        {
+            pinned.empty_reply = EMPTY_BOARD_REPLY;
+            return pinned;
+        }
+
+        size_t first = first_position_after(filter.after_id);
+        std::optional<reaction_kind> reaction;
+        if (filter.reaction)
+        {
+            reaction = parse_reaction(*filter.reaction);
+        }
+        auto select_if_due = [&](size_t position) -> bool
+        {
+            if (pinned.positions.size() == filter.limit)
+            {
+                return false;
+            }
+            if (!reaction
+                || at(position).reaction.load(std::memory_order_relaxed)
+                       == *reaction)
+            {
+                pinned.positions.push_back(position);
+            }
+            return true;
+        };
+
+        // Drive the walk from the narrowest index so filtered reads cost
+        // O(result) instead of O(board).
+        if (filter.sender_ip)
+        {
+            pinned.use_positions = true;
+            auto it_sender       = sender_index.find(*filter.sender_ip);
+            if (it_sender != sender_index.end())
+            {
+                const auto &positions = it_sender->second;
+                auto        it_pos
+                    = std::lower_bound(positions.begin(), positions.end(), first);
+                while (it_pos != positions.end() && select_if_due(*it_pos))
+                {
+                    ++it_pos;
+                }
+            }
+        }
+        else if (reaction)
+        {
+            pinned.use_positions  = true;
+            const auto &positions = reaction_index[reaction_slot(*reaction)];
+            auto        it_pos    = positions.lower_bound(first);
+            while (it_pos != positions.end() && select_if_due(*it_pos))
+            {
+                ++it_pos;
+            }
+        }
+        else
+        {
+            // Unfiltered reads are a contiguous run; no position list needed.
+            pinned.first = first;
+            pinned.last  = first + std::min(filter.limit, message_count - first);
+        }
+
+        return pinned;
+    }
+
+    auto message_store::render(const message_filter &filter) const -> std::string
+    {
+        return snapshot(filter).render();
+    }
+
+    auto message_store::search(std::string_view term, size_t limit) const
+        -> std::string
+    {
+        std::string rendered;
+        size_t      matches = 0;
+
+        if (term.size() < TRIGRAM_LENGTH)
+        {
+            // Too short to use the index: fall back to a scan.
+            for (size_t position = 0; position < message_count; ++position)
+            {
+                if (matches == limit)
+                {
+                    break;
+                }
+                const message &msg_item = at(position);
+                if (contains(msg_item.text, term))
+                {
+                    append_rendered(rendered, msg_item);
+                    ++matches;
+                }
+            }
+        }
+        else
+        {
+            std::vector<const std::vector<size_t> *> posting_lists;
+            for (size_t i = 0; i + TRIGRAM_LENGTH <= term.size(); ++i)
+            {
+                auto it_postings
+                    = trigram_index.find(pack_trigram(term.data() + i));
+                if (it_postings == trigram_index.end())
+                {
+                    return std::string(NO_MATCH_REPLY);
+                }
+                posting_lists.push_back(&it_postings->second);
+            }
+
+            // Drive the intersection from the rarest trigram so the work is
+            // bounded by its posting list, not by the board size.
+            std::sort(
+                posting_lists.begin(),
+                posting_lists.end(),
+                [](const auto *lhs, const auto *rhs)
+                {
+                    return lhs->size() != rhs->size() ? lhs->size() < rhs->size()
+                                                      : lhs < rhs;
+                }
+            );
+            posting_lists.erase(
+                std::unique(posting_lists.begin(), posting_lists.end()),
+                posting_lists.end()
+            );
+
+            for (size_t position : *posting_lists.front())
+            {
+                if (matches == limit)
+                {
+                    break;
+                }
+                bool in_all = std::all_of(
+                    posting_lists.begin() + 1,
+                    posting_lists.end(),
+                    [position](const auto *postings)
+                    {
+                        return std::binary_search(
+                            postings->begin(),
+                            postings->end(),
+                            position
+                        );
+                    }
+                );
+                // Trigram hits are only candidates; confirm the full term.
+                if (in_all && contains(at(position).text, term))
+                {
+                    append_rendered(rendered, at(position));
+                    ++matches;
+                }
+            }
+        }
+
+        if (matches == 0)
+        {
+            return std::string(NO_MATCH_REPLY);
+        }
+
+        return rendered;
+    }
+
+}
@@ -0,0 +1,262 @@
+#include <oreore/message_text.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OREORE_X86_SIMD
+#endif
+
+namespace oreore
+{
+    namespace
+    {
+        // Printable ASCII other than the two bytes the Msg field escapes.
+        // Everything else leaves the fast path.
+        auto is_plain(unsigned char byte) -> bool
+        {
+            return byte >= 0x20 && byte < 0x7F && byte != '"' && byte != '\\';
+        }
+
+        // Each scanner returns the length of the plain prefix of text.
+        auto scan_plain_scalar(const char *text, size_t length) -> size_t
+        {
+            size_t offset = 0;
+            while (offset < length && is_plain(text[offset]))
+            {
+                ++offset;
+            }
+            return offset;
+        }
+
+#ifdef OREORE_X86_SIMD
+        // The compare against 0x20 is signed, so bytes of 0x80 and above
+        // count as "below" it together with the control bytes.
+        __attribute__((target("sse4.1"))) auto
+            scan_plain_sse41(const char *text, size_t length) -> size_t
+        {
+            const __m128i space     = _mm_set1_epi8(0x20);
+            const __m128i del       = _mm_set1_epi8(0x7F);
+            const __m128i quote     = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+
+            size_t offset = 0;
+            for (; offset + 16 <= length; offset += 16)
+            {
+                __m128i chunk = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(text + offset)
+                );
+                __m128i special = _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_cmpgt_epi8(space, chunk),
+                        _mm_cmpeq_epi8(chunk, del)
+                    ),
+                    _mm_or_si128(
+                        _mm_cmpeq_epi8(chunk, quote),
+                        _mm_cmpeq_epi8(chunk, backslash)
+                    )
+                );
+                if (!_mm_testz_si128(special, special))
+                {
+                    return offset
+                         + __builtin_ctz(
+                               static_cast<unsigned>(_mm_movemask_epi8(special))
+                         );
+                }
+            }
+            return offset + scan_plain_scalar(text + offset, length - offset);
+        }
+
+        __attribute__((target("avx2"))) auto
+            scan_plain_avx2(const char *text, size_t length) -> size_t
+        {
+            const __m256i space     = _mm256_set1_epi8(0x20);
+            const __m256i del       = _mm256_set1_epi8(0x7F);
+            const __m256i quote     = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+
+            size_t offset = 0;
+            for (; offset + 32 <= length; offset += 32)
+            {
+                __m256i chunk = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(text + offset)
+                );
+                __m256i special = _mm256_or_si256(
+                    _mm256_or_si256(
+                        _mm256_cmpgt_epi8(space, chunk),
+                        _mm256_cmpeq_epi8(chunk, del)
+                    ),
+                    _mm256_or_si256(
+                        _mm256_cmpeq_epi8(chunk, quote),
+                        _mm256_cmpeq_epi8(chunk, backslash)
+                    )
+                );
+                if (!_mm256_testz_si256(special, special))
+                {
+                    return offset
+                         + __builtin_ctz(
+                               static_cast<unsigned>(_mm256_movemask_epi8(special))
+                         );
+                }
+            }
+            return offset + scan_plain_scalar(text + offset, length - offset);
+        }
+#endif
+
+        using plain_scanner = size_t (*)(const char *, size_t);
+
+        struct scanner_choice
+        {
+            plain_scanner    scan;
+            std::string_view name;
+        };
+
+        auto choose_scanner(void) -> scanner_choice
+        {
+#ifdef OREORE_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return { scan_plain_avx2, "avx2" };
+            }
+            if (__builtin_cpu_supports("sse4.1"))
+            {
+                return { scan_plain_sse41, "sse4.1" };
+            }
+#endif
+            return { scan_plain_scalar, "scalar" };
+        }
+
+        auto selected_scanner(void) -> const scanner_choice &
+        {
+            static const scanner_choice choice = choose_scanner();
+            return choice;
+        }
+
+        auto in_range(unsigned char byte, unsigned char low, unsigned char high)
+            -> bool
+        {
+            return byte >= low && byte <= high;
+        }
+
+        // Length of the well-formed UTF-8 sequence at the start of text, or
+        // 0. Overlong forms, surrogates and code points past U+10FFFF are
+        // malformed (Unicode table 3-7).
+        auto utf8_sequence_length(std::string_view text) -> size_t
+        {
+            auto byte_at = [&](size_t index) -> unsigned char
+            {
+                return static_cast<unsigned char>(text[index]);
+            };
+            unsigned char lead = byte_at(0);
+
+            size_t        length;
+            unsigned char second_low  = 0x80;
+            unsigned char second_high = 0xBF;
+            if (in_range(lead, 0xC2, 0xDF))
+            {
+                length = 2;
+            }
+            else if (in_range(lead, 0xE0, 0xEF))
+            {
+                length      = 3;
+                second_low  = lead == 0xE0 ? 0xA0 : 0x80;
+                second_high = lead == 0xED ? 0x9F : 0xBF;
+            }
+            else if (in_range(lead, 0xF0, 0xF4))
+            {
+                length      = 4;
+                second_low  = lead == 0xF0 ? 0x90 : 0x80;
+                second_high = lead == 0xF4 ? 0x8F : 0xBF;
+            }
+            else
+            {
+                return 0;
+            }
+
+            if (text.size() < length || !in_range(byte_at(1), second_low, second_high))
+            {
+                return 0;
+            }
+            for (size_t index = 2; index < length; ++index)
+            {
+                if (!in_range(byte_at(index), 0x80, 0xBF))
+                {
+                    return 0;
+                }
+            }
+            return length;
+        }
+    }
+
+    auto normalize_message_text(std::string_view text, size_t max_length)
+        -> std::expected<std::string, std::string>
+    {
+        if (text.size() > max_length)
+        {
+            return std::unexpected(
+                "ERR: Message exceeds " + std::to_string(max_length) + " bytes.\n"
+            );
+        }
+
+        plain_scanner scan = selected_scanner().scan;
+        std::string   normalized;
+        normalized.reserve(text.size());
+
+        size_t position = 0;
+        while (true)
+        {
+            size_t plain = scan(text.data() + position, text.size() - position);
+            normalized.append(text.data() + position, plain);
+            position += plain;
+            if (position == text.size())
+            {
+                break;
+            }
+
+            // Non-ASCII text tends to come in runs, so stay here until the
+            // next ASCII byte rather than bouncing through the scanner.
+            while (position < text.size())
+            {
+                unsigned char byte = static_cast<unsigned char>(text[position]);
+                if (byte == '"' || byte == '\\')
+                {
+                    normalized += '\\';
+                    normalized += static_cast<char>(byte);
+                    ++position;
+                    continue;
+                }
+                if (byte == '\t')
+                {
+                    normalized += '\t';
+                    ++position;
+                    continue;
+                }
+                if (byte < 0x80)
+                {
+                    if (!is_plain(byte))
+                    {
+                        return std::unexpected(
+                            "ERR: Message contains control characters.\n"
+                        );
+                    }
+                    break;
+                }
+
+                size_t sequence_length = utf8_sequence_length(text.substr(position));
+                if (sequence_length == 0)
+                {
+                    return std::unexpected("ERR: Message is not valid UTF-8.\n");
+                }
+                normalized.append(text.data() + position, sequence_length);
+                position += sequence_length;
+            }
+        }
+
+        return normalized;
+    }
+
+    auto message_text_scanner(void) -> std::string_view
+    {
+        return selected_scanner().name;
+    }
+
+}
@@ -0,0 +1,84 @@
+#include <oreore/message.hpp>
+#include <oreore/outbound_socket.hpp>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace oreore
+{
+    auto parse_remote_address(const std::string &address)
+        -> std::expected<remote_address, std::string>
+    {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos || colon == 0)
+        {
+            return std::unexpected("expected host:port, got '" + address + "'");
+        }
+        auto port = parse_unsigned(std::string_view(address).substr(colon + 1));
+        if (!port || *port == 0 || *port > 0xFFFF)
+        {
+            return std::unexpected("invalid port in '" + address + "'");
+        }
+
+        return remote_address { address.substr(0, colon), static_cast<uint16_t>(*port) };
+    }
+
+    auto describe_remote_address(const remote_address &address) -> std::string
+    {
+        return address.host + ":" + std::to_string(address.port);
+    }
+
+    auto start_outbound_connect(const remote_address &address)
+        -> std::expected<scoped_file_descriptor, std::string>
+    {
+        addrinfo  hints {};
+        addrinfo *resolved = nullptr;
+        hints.ai_family    = AF_INET;
+        hints.ai_socktype  = SOCK_STREAM;
+        std::string port   = std::to_string(address.port);
+        if (int rc = getaddrinfo(address.host.c_str(), port.c_str(), &hints, &resolved);
+            rc != 0)
+        {
+            return std::unexpected(
+                "cannot resolve " + describe_remote_address(address) + ": "
+                + gai_strerror(rc)
+            );
+        }
+
+        scoped_file_descriptor fd(
+            socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)
+        );
+        if (fd.get() == -1)
+        {
+            freeaddrinfo(resolved);
+            return std::unexpected(make_errno_message("socket() failed"));
+        }
+        int rc = ::connect(fd.get(), resolved->ai_addr, resolved->ai_addrlen);
+        freeaddrinfo(resolved);
+        if (rc == -1 && errno != EINPROGRESS)
+        {
+            return std::unexpected(make_errno_message(
+                "connect to " + describe_remote_address(address) + " failed"
+            ));
+        }
+
+        return fd;
+    }
+
+    auto check_outbound_connect(int socket_fd) -> std::expected<void, std::string>
+    {
+        int       socket_error = 0;
+        socklen_t error_length = sizeof(socket_error);
+        if (getsockopt(socket_fd, SOL_SOCKET, SO_ERROR, &socket_error, &error_length)
+                == -1
+            || socket_error != 0)
+        {
+            errno = socket_error != 0 ? socket_error : errno;
+            return std::unexpected(make_errno_message("connect failed"));
+        }
+
+        return {};
+    }
+
+}
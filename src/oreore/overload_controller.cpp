@@ -0,0 +1,130 @@
+#include <oreore/overload_controller.hpp>
+
+#include <algorithm>
+
+namespace oreore
+{
+    namespace
+    {
+        // Pressure is the larger of lag and buffered bytes, each as a
+        // fraction of its limit.
+        inline constexpr double ENTER_THROTTLED = 0.5;
+        inline constexpr double LEAVE_THROTTLED = 0.25;
+        inline constexpr double ENTER_SHEDDING  = 1.0;
+        inline constexpr double LEAVE_SHEDDING  = 0.75;
+        // Weight of the newest lag sample in the moving average: 1/8.
+        inline constexpr int64_t LAG_SMOOTHING_SHIFT = 3;
+    }
+
+    auto overload_level_name(overload_level level) -> std::string_view
+    {
+        switch (level)
+        {
+            case overload_level::normal:
+                return "normal";
+            case overload_level::throttled:
+                return "throttled";
+            case overload_level::shedding:
+                return "shedding";
+        }
+        return "unknown";
+    }
+
+    overload_controller::overload_controller(const overload_limits &configured)
+        : limits(configured)
+        , level(overload_level::normal)
+        , smoothed_lag(0)
+        , buffered_bytes(0)
+        , next_sample(clock::time_point::min())
+    {
+    }
+
+    auto overload_controller::record_loop_lag(clock::duration lag) -> void
+    {
+        int64_t sample
+            = std::chrono::duration_cast<std::chrono::microseconds>(lag).count();
+        int64_t current = smoothed_lag.count();
+        smoothed_lag    = std::chrono::microseconds(
+            current + ((sample - current) >> LAG_SMOOTHING_SHIFT)
+        );
+    }
+
+    auto overload_controller::sample_due(clock::time_point now) const -> bool
+    {
+        return now >= next_sample;
+    }
+
+    auto overload_controller::update(size_t buffered, clock::time_point now)
+        -> overload_level
+    {
+        buffered_bytes = buffered;
+        next_sample    = now + OVERLOAD_SAMPLE_INTERVAL;
+
+        double pressure = 0.0;
+        if (limits.lag_limit.count() > 0)
+        {
+            pressure = static_cast<double>(smoothed_lag.count())
+                     / static_cast<double>(limits.lag_limit.count());
+        }
+        if (limits.buffered_limit > 0)
+        {
+            pressure = std::max(
+                pressure,
+                static_cast<double>(buffered_bytes)
+                    / static_cast<double>(limits.buffered_limit)
+            );
+        }
+
+        switch (level)
+        {
+            case overload_level::normal:
+                if (pressure >= ENTER_SHEDDING)
+                {
+                    level = overload_level::shedding;
+                }
+                else if (pressure >= ENTER_THROTTLED)
+                {
+                    level = overload_level::throttled;
+                }
+                break;
+            case overload_level::throttled:
+                if (pressure >= ENTER_SHEDDING)
+                {
+                    level = overload_level::shedding;
+                }
+                else if (pressure < LEAVE_THROTTLED)
+                {
+                    level = overload_level::normal;
+                }
+                break;
+            case overload_level::shedding:
+                if (pressure < LEAVE_THROTTLED)
+                {
+                    level = overload_level::normal;
+                }
+                else if (pressure < LEAVE_SHEDDING)
+                {
+                    level = overload_level::throttled;
+                }
+                break;
+        }
+        return level;
+    }
+
+    auto overload_controller::get_level(void) const -> overload_level
+    {
+        return level;
+    }
+
+    auto overload_controller::get_smoothed_lag(void) const
+        -> std::chrono::microseconds
+    {
+        return smoothed_lag;
+    }
+
+    auto overload_controller::get_buffered_bytes(void) const -> size_t
+    {
+        return buffered_bytes;
+    }
+
+}
@@ -0,0 +1,64 @@
+#include <oreore/peer_address.hpp>
+
+namespace oreore
+{
+    peer_address::peer_address(ip_address &&address) : identity(std::move(address))
+    {
+    }
+
+    peer_address::peer_address(std::string &&local_identity)
+        : identity(std::move(local_identity))
+    {
+    }
+
+    auto peer_address::make(ip_address &&address)
+        -> std::expected<peer_address, std::string>
+    {
+        if (!address.get_raw().has_value())
+        {
+            return std::unexpected("peer_address::make error: Provided "
+                                   "ip_address is not fully initialized.");
+        }
+        return peer_address(std::move(address));
+    }
+
+    auto peer_address::make_local(pid_t pid, uid_t uid)
+        -> std::expected<peer_address, std::string>
+    {
+        return peer_address(
+            std::string(LOCAL_PEER_PREFIX) + "pid=" + std::to_string(pid)
+            + ",uid=" + std::to_string(uid)
+        );
+    }
+
+    auto peer_address::parse(const std::string &peer_string)
+        -> std::expected<peer_address, std::string>
+    {
+        if (peer_string.starts_with(LOCAL_PEER_PREFIX))
+        {
+            return peer_address(std::string(peer_string));
+        }
+
+        auto ip = ip_address::make(peer_string);
+        if (!ip)
+        {
+            return std::unexpected(ip.error());
+        }
+        return peer_address(std::move(ip.value()));
+    }
+
+    auto peer_address::is_local(void) const -> bool
+    {
+        return std::holds_alternative<std::string>(identity);
+    }
+
+    auto peer_address::get_string(void) const -> std::string
+    {
+        if (const auto *local_identity = std::get_if<std::string>(&identity))
+        {
+            return *local_identity;
+        }
+        return std::get<ip_address>(identity).get_string().value_or("Unknown IP");
+    }
+
+}
@@ -0,0 +1,139 @@
+#include <oreore/message.hpp>
+#include <oreore/render_pool.hpp>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utility>
+
+namespace oreore
+{
+    render_pool::render_pool(scoped_file_descriptor &&event_fd)
+        : busy_workers(0)
+        , stopping(false)
+        , completion_fd(std::move(event_fd))
+    {
+    }
+
+    render_pool::~render_pool(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            stopping = true;
+        }
+        jobs_ready.notify_all();
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    auto render_pool::make(size_t worker_count)
+        -> std::expected<std::unique_ptr<render_pool>, std::string>
+    {
+        if (worker_count == 0 || worker_count > MAX_RENDER_WORKERS)
+        {
+            return std::unexpected(
+                "Render worker count must be 1-" + std::to_string(MAX_RENDER_WORKERS)
+                + "."
+            );
+        }
+
+        scoped_file_descriptor event_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        if (event_fd.get() == -1)
+        {
+            return std::unexpected(make_errno_message("eventfd failed"));
+        }
+
+        std::unique_ptr<render_pool> pool(new render_pool(std::move(event_fd)));
+        for (size_t i = 0; i < worker_count; ++i)
+        {
+            pool->workers.emplace_back(&render_pool::worker_main, pool.get());
+        }
+
+        return pool;
+    }
+
+    auto run_render_job(const render_job &job) -> std::string
+    {
+        if (!job.compression_level)
+        {
+            return job.snapshot.render();
+        }
+        return make_compressed_frame(job.snapshot.render(), *job.compression_level);
+    }
+
+    auto render_pool::worker_main(void) -> void
+    {
+        while (true)
+        {
+            render_job job;
+            {
+                std::unique_lock<std::mutex> lock(jobs_mutex);
+                jobs_ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping)
+                {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                ++busy_workers;
+            }
+
+            std::string rendered = run_render_job(job);
+            // Drop the pinned segments here rather than on the loop thread.
+            job.snapshot = message_snapshot();
+            {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results.push_back({ job.client_fd, job.ticket, std::move(rendered) });
+            }
+            uint64_t one = 1;
+            if (write(completion_fd.get(), &one, sizeof(one)) == -1 && errno != EAGAIN)
+            {
+                perror("eventfd write error");
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(jobs_mutex);
+                --busy_workers;
+            }
+            jobs_done.notify_all();
+        }
+    }
+
+    auto render_pool::get_completion_fd(void) const -> int
+    {
+        return completion_fd.get();
+    }
+
+    auto render_pool::try_submit(render_job &job) -> bool
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            if (jobs.size() >= RENDER_QUEUE_LIMIT)
+            {
+                return false;
+            }
+            jobs.push_back(std::move(job));
+        }
+        jobs_ready.notify_one();
+        return true;
+    }
+
+    auto render_pool::take_results(void) -> std::vector<render_result>
+    {
+        uint64_t signalled;
+        while (read(completion_fd.get(), &signalled, sizeof(signalled)) > 0)
+        {
+        }
+
+        std::lock_guard<std::mutex> lock(results_mutex);
+        return std::exchange(results, {});
+    }
+
+    auto render_pool::wait_idle(void) -> void
+    {
+        std::unique_lock<std::mutex> lock(jobs_mutex);
+        jobs_done.wait(lock, [this] { return jobs.empty() && busy_workers == 0; });
+    }
+
+}
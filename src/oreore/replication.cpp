@@ -0,0 +1,197 @@
+#include <oreore/message.hpp>
+#include <oreore/replication.hpp>
+
+#include <sys/socket.h>
+
+namespace oreore
+{
+    auto format_replication_event(
+        uintmax_t              sequence,
+        replication_event_kind kind,
+        uintmax_t              message_id,
+        std::string_view       sender_ip,
+        std::string_view       text
+    ) -> std::string
+    {
+        std::string line = "EV " + std::to_string(sequence);
+        switch (kind)
+        {
+            case replication_event_kind::post:
+                line.append(" POST ").append(std::to_string(message_id));
+                line.append(" ").append(sender_ip).append(" ").append(text);
+                break;
+
+            case replication_event_kind::happy:
+                line.append(" HAPPY ").append(std::to_string(message_id));
+                break;
+
+            case replication_event_kind::sad:
+                line.append(" SAD ").append(std::to_string(message_id));
+                break;
+        }
+        line.push_back('\n');
+
+        return line;
+    }
+
+    auto parse_replication_event(std::string_view line)
+        -> std::expected<replication_event, std::string>
+    {
+        // Splits off the next space-delimited field.
+        auto next_field = [&line](void) -> std::string_view
+        {
+            size_t           space = line.find(' ');
+            std::string_view field = line.substr(0, space);
+            line.remove_prefix(space == std::string_view::npos ? line.size()
+                                                               : space + 1);
+            return field;
+        };
+
+        if (next_field() != "EV")
+        {
+            return std::unexpected("replication: expected EV line");
+        }
+
+        replication_event event {};
+        auto              sequence = parse_unsigned(next_field());
+        std::string_view  kind     = next_field();
+        auto              id       = parse_unsigned(next_field());
+        if (!sequence || !id)
+        {
+            return std::unexpected("replication: malformed sequence or ID");
+        }
+        event.sequence   = *sequence;
+        event.message_id = *id;
+
+        if (kind == "POST")
+        {
+            event.kind      = replication_event_kind::post;
+            event.sender_ip = next_field();
+            event.text      = line;
+        }
+        else if (kind == "HAPPY")
+        {
+            event.kind = replication_event_kind::happy;
+        }
+        else if (kind == "SAD")
+        {
+            event.kind = replication_event_kind::sad;
+        }
+        else
+        {
+            return std::unexpected(
+                "replication: unknown event kind '" + std::string(kind) + "'"
+            );
+        }
+
+        return event;
+    }
+
+    replication_link::replication_link(remote_address address)
+        : primary(std::move(address))
+        , connected(false)
+    {
+    }
+
+    replication_link::replication_link(replication_link &&other) noexcept
+        : primary(std::move(other.primary))
+        , socket_fd(std::move(other.socket_fd))
+        , read_buffer(std::move(other.read_buffer))
+        , connected(other.connected)
+    {
+        other.connected = false;
+    }
+
+    auto replication_link::operator=(replication_link &&other) noexcept
+        -> replication_link &
+    {
+        if (this != &other)
+        {
+            primary         = std::move(other.primary);
+            socket_fd       = std::move(other.socket_fd);
+            read_buffer     = std::move(other.read_buffer);
+            connected       = other.connected;
+            other.connected = false;
+        }
+
+        return *this;
+    }
+
+    auto replication_link::make(const std::string &address)
+        -> std::expected<replication_link, std::string>
+    {
+        auto parsed = parse_remote_address(address);
+        if (!parsed)
+        {
+            return std::unexpected("replication_link::make error: " + parsed.error());
+        }
+
+        return replication_link(std::move(*parsed));
+    }
+
+    auto replication_link::start_connect(void) -> std::expected<void, std::string>
+    {
+        disconnect();
+
+        auto fd = start_outbound_connect(primary);
+        if (!fd)
+        {
+            return std::unexpected("replication: " + fd.error());
+        }
+
+        socket_fd = std::move(*fd);
+        return {};
+    }
+
+    auto replication_link::finish_connect(uintmax_t next_sequence)
+        -> std::expected<void, std::string>
+    {
+        if (auto result = check_outbound_connect(socket_fd.get()); !result)
+        {
+            return std::unexpected(
+                "replication: " + result.error() + " (" + get_address() + ")"
+            );
+        }
+
+        // The subscribe line is tiny, so a fresh socket always accepts it.
+        std::string subscribe = std::string(REPLICATE_COMMAND) + " "
+                              + std::to_string(next_sequence) + "\n";
+        if (send(socket_fd.get(), subscribe.data(), subscribe.size(), MSG_NOSIGNAL)
+            != static_cast<ssize_t>(subscribe.size()))
+        {
+            return std::unexpected(make_errno_message("replication: subscribe failed"
+            ));
+        }
+        connected = true;
+
+        return {};
+    }
+
+    auto replication_link::disconnect(void) -> void
+    {
+        socket_fd = scoped_file_descriptor();
+        read_buffer.clear();
+        connected = false;
+    }
+
+    auto replication_link::get_fd(void) const -> int
+    {
+        return socket_fd.get();
+    }
+
+    auto replication_link::is_connected(void) const -> bool
+    {
+        return connected;
+    }
+
+    auto replication_link::get_address(void) const -> std::string
+    {
+        return describe_remote_address(primary);
+    }
+
+    auto replication_link::get_read_buffer(void) -> std::string &
+    {
+        return read_buffer;
+    }
+
+}
@@ -6,16 +6,31 @@
 #include <iostream>
 #include <sstream>
 #include <sys/epoll.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 
 namespace oreore
 {
 
     // --- Private Constructor ---
-    server::server(scoped_file_descriptor &&epoll_fd, scoped_file_descriptor &&server_fd)
+    server::server(
+        scoped_file_descriptor &&epoll_fd,
+        std::vector<scoped_file_descriptor> &&listeners,
+        const server_options                 &server_config
+    )
         : epoll_file_descriptor(std::move(epoll_fd))
-        , server_file_descriptor(std::move(server_fd))
-        , next_message_id(0)
+        , listener_fds(std::move(listeners))
+        , options(server_config)
+        , store(
+              server_config.shard_index ? message_store(*server_config.shard_index)
+                                        : message_store()
+          )
+        , running_connection_fd(-1)
+        , overload(server_config.overload)
+        , accepting(true)
+        , buffered_bytes(0)
+        , next_render_ticket(0)
+        , draining(false)
     {
     }
 
@@ -28,17 +43,37 @@ namespace oreore
         }
     }
 
-    // --- Move Constructor & Assignment (custom implementation for std::mutex)
-    // ---
+    // --- Move Constructor & Assignment ---
     server::server(server &&other) noexcept
         : epoll_file_descriptor(std::move(other.epoll_file_descriptor))
-        , server_file_descriptor(std::move(other.server_file_descriptor))
-        , messages(std::move(other.messages))
-        , next_message_id(other.next_message_id)
+        , listener_fds(std::move(other.listener_fds))
+        , options(std::move(other.options))
+        , store(std::move(other.store))
         , client_connections(std::move(other.client_connections))
+        , closed_clients(std::move(other.closed_clients))
+        , running_connection_fd(other.running_connection_fd)
+        , primary_link(std::move(other.primary_link))
+        , replication_timer_fd(std::move(other.replication_timer_fd))
+        , replica_subscribers(std::move(other.replica_subscribers))
+        , shard_links(std::move(other.shard_links))
+        , placement(std::move(other.placement))
+        , shard_waiters(std::move(other.shard_waiters))
+        , ready_shard_calls(std::move(other.ready_shard_calls))
+        , loop_stats(other.loop_stats)
+        , overload(other.overload)
+        , accepting(other.accepting)
+        , buffered_bytes(other.buffered_bytes)
+        , renderer(std::move(other.renderer))
+        , next_render_ticket(other.next_render_ticket)
+        , render_waiters(std::move(other.render_waiters))
+        , tracer(std::move(other.tracer))
+        , recorder(std::move(other.recorder))
+        , board_mirror(std::move(other.board_mirror))
+        , handoff_listener_fd(std::move(other.handoff_listener_fd))
+        , takeover(std::move(other.takeover))
+        , draining(other.draining)
+        , drain_deadline(other.drain_deadline)
     {
-        // messages_mutex is default-initialized in the new object
-        other.next_message_id = 0;
     }
 
     auto server::operator=(server &&other) noexcept -> server &
@@ -48,16 +83,33 @@ namespace oreore
             return *this;
         }
         epoll_file_descriptor  = std::move(other.epoll_file_descriptor);
-        server_file_descriptor = std::move(other.server_file_descriptor);
+        listener_fds           = std::move(other.listener_fds);
+        options                = std::move(other.options);
         client_connections     = std::move(other.client_connections);
-
-        std::lock_guard<std::mutex> lock_this(messages_mutex); // Lock self
-                                                               // before
-                                                               // modifying
-        messages              = std::move(other.messages);
-        next_message_id       = other.next_message_id;
-
-        other.next_message_id = 0;
+        closed_clients         = std::move(other.closed_clients);
+        running_connection_fd  = other.running_connection_fd;
+        store                  = std::move(other.store);
+        primary_link           = std::move(other.primary_link);
+        replication_timer_fd   = std::move(other.replication_timer_fd);
+        replica_subscribers    = std::move(other.replica_subscribers);
+        shard_links            = std::move(other.shard_links);
+        placement              = std::move(other.placement);
+        shard_waiters          = std::move(other.shard_waiters);
+        ready_shard_calls      = std::move(other.ready_shard_calls);
+        loop_stats             = other.loop_stats;
+        overload               = other.overload;
+        accepting              = other.accepting;
+        buffered_bytes         = other.buffered_bytes;
+        renderer               = std::move(other.renderer);
+        next_render_ticket     = other.next_render_ticket;
+        render_waiters         = std::move(other.render_waiters);
+        tracer                 = std::move(other.tracer);
+        recorder               = std::move(other.recorder);
+        board_mirror           = std::move(other.board_mirror);
+        handoff_listener_fd    = std::move(other.handoff_listener_fd);
+        takeover               = std::move(other.takeover);
+        draining               = other.draining;
+        drain_deadline         = other.drain_deadline;
 
         return *this;
     }
@@ -115,57 +167,139 @@ namespace oreore
             return;
         }
 
-        if (reason)
+        if (reason && options.log_connections)
         {
             std::cout << "Closing client "
-                      << client_iterator->second.get_ip_string() << " (socket "
+                      << client_iterator->second.get_peer_string() << " (socket "
                       << client_fd << "): " << reason << std::endl;
         }
+        if (recorder)
+        {
+            recorder->record_close(client_fd);
+        }
         unregister_descriptor(client_fd);
-        client_connections.erase(client_iterator);
+        replica_subscribers.erase(client_fd);
+        buffered_bytes -= client_iterator->second.get_read_buffer().size()
+                        + client_iterator->second.get_write_buffer().size();
+        if (client_fd == running_connection_fd)
+        {
+            // Its coroutine is still on the stack; free the frame once it has
+            // suspended.
+            closed_clients.push_back(client_connections.extract(client_iterator));
+        }
+        else
+        {
+            client_connections.erase(client_iterator);
+        }
+    }
+
+    namespace
+    {
+        // Local peers have no address worth logging; their credentials
+        // identify them instead.
+        auto make_peer_address(int client_fd, const sockaddr_storage &address)
+            -> std::expected<peer_address, std::string>
+        {
+            if (address.ss_family == AF_UNIX)
+            {
+                ucred     credentials {};
+                socklen_t credentials_length = sizeof(credentials);
+                if (getsockopt(
+                        client_fd,
+                        SOL_SOCKET,
+                        SO_PEERCRED,
+                        &credentials,
+                        &credentials_length
+                    )
+                    == -1)
+                {
+                    return std::unexpected(
+                        make_errno_message("getsockopt(SO_PEERCRED) failed")
+                    );
+                }
+                return peer_address::make_local(credentials.pid, credentials.uid);
+            }
+
+            const auto &inet_address
+                = reinterpret_cast<const sockaddr_in &>(address);
+            auto ip = ip_address::make(ntohl(inet_address.sin_addr.s_addr));
+            if (!ip)
+            {
+                return std::unexpected(ip.error());
+            }
+            return peer_address::make(std::move(ip.value()));
+        }
     }
 
     // --- Event Handlers ---
-    auto server::accept_new_connections(void) -> void
+    auto server::is_listener(int fd) const -> bool
+    {
+        return std::ranges::any_of(
+            listener_fds,
+            [fd](const scoped_file_descriptor &listener)
+            { return listener.get() == fd; }
+        );
+    }
+
+    auto server::accept_new_connections(int listener_fd) -> void
     {
         while (true)
         {
-            sockaddr_in client_address {};
-            socklen_t   client_len    = sizeof(client_address);
-            int         client_fd_val = accept(
-                server_file_descriptor.get(),
+            // Further connections wait in the kernel's backlog.
+            if (at_connection_limit())
+            {
+                set_accepting(false);
+                break;
+            }
+
+            // The socket comes back non-blocking and close-on-exec, which
+            // saves the fcntl round trips per connection.
+            sockaddr_storage client_address {};
+            socklen_t        client_len    = sizeof(client_address);
+            int              client_fd_val = accept4(
+                listener_fd,
                 (struct sockaddr *)&client_address,
-                &client_len
+                &client_len,
+                SOCK_NONBLOCK | SOCK_CLOEXEC
             );
 
             if (client_fd_val == -1)
             {
                 if (errno == EAGAIN || errno == EWOULDBLOCK)
                     break;
+                // The peer gave up while queued; the rest of the backlog
+                // is still worth taking.
+                if (errno == ECONNABORTED || errno == EINTR)
+                    continue;
                 perror("accept error");
                 break;
             }
+            OREORE_PROBE1(accept, client_fd_val);
 
             scoped_file_descriptor scoped_client_fd(client_fd_val
             ); // RAII for the accepted fd
 
-            auto non_blocking_res
-                = make_socket_non_blocking(scoped_client_fd.get());
-            if (!non_blocking_res)
+            if (client_address.ss_family != AF_UNIX)
             {
-                std::cerr << "Failed to make socket non-blocking for fd "
-                          << scoped_client_fd.get() << ": "
-                          << non_blocking_res.error() << std::endl;
-                continue; // Try next accept
+                if (auto tune_res
+                    = tune_connection(scoped_client_fd.get(), options.latency);
+                    !tune_res)
+                {
+                    std::cerr << "Socket tuning incomplete for fd "
+                              << scoped_client_fd.get() << ": " << tune_res.error()
+                              << std::endl;
+                }
             }
 
-            auto ip_expected
-                = ip_address::make(ntohl(client_address.sin_addr.s_addr));
-            if (!ip_expected)
+            // TCP peers keep the raw address; its text is formatted when
+            // first logged or posted under.
+            auto peer_expected
+                = make_peer_address(scoped_client_fd.get(), client_address);
+            if (!peer_expected)
             {
-                std::cerr << "Failed to create ip_address for fd "
+                std::cerr << "Failed to identify peer for fd "
                           << scoped_client_fd.get() << ": "
-                          << ip_expected.error() << std::endl;
+                          << peer_expected.error() << std::endl;
                 continue; // Try next accept
             }
 
@@ -173,12 +307,13 @@ namespace oreore
             // ownership
             auto conn_expected = client_connection::make(
                 scoped_client_fd.release(),
-                std::move(ip_expected.value())
+                std::move(peer_expected.value())
             );
             if (!conn_expected)
             {
                 std::cerr << "Failed to create client_connection: "
                           << conn_expected.error() << std::endl;
+                continue; // Try next accept
             }
 
             client_connection new_conn = std::move(conn_expected.value());
@@ -197,344 +332,1394 @@ namespace oreore
                 continue; // Try next accept
             }
 
-            std::cout << "Accepted new connection from "
-                      << new_conn.get_ip_string() << " on socket "
-                      << new_client_fd_val << std::endl;
-            client_connections.emplace(new_client_fd_val, std::move(new_conn));
+            if (options.log_connections)
+            {
+                std::cout << "Accepted new connection from "
+                          << new_conn.get_peer_string() << " on socket "
+                          << new_client_fd_val << std::endl;
+            }
+            auto [client_iterator, inserted]
+                = client_connections.emplace(new_client_fd_val, std::move(new_conn));
+            start_connection(client_iterator->second);
         }
     }
 
-    auto server::process_client_command(
-        client_connection &client,
-        const std::string &command_line
-    ) -> void
+    auto server::at_connection_limit(void) const -> bool
     {
-        std::cout << "Processing for " << client.get_ip_string() << " (socket "
-                  << client.get_fd() << "): " << command_line << std::endl;
-        std::string        response_str;
-        std::istringstream iss_cmd(command_line);
-        std::string        command_token;
-        iss_cmd >> command_token;
+        return options.max_connections > 0
+            && client_connections.size() >= options.max_connections;
+    }
 
-        if (command_token == "POST")
+    auto server::set_accepting(bool enabled) -> void
+    {
+        if (accepting == enabled)
         {
-            std::string message_text;
-            if (command_line.rfind("POST ", 0) == 0)
+            return;
+        }
+        accepting = enabled;
+        if (!enabled)
+        {
+            ++loop_stats.accept_pauses;
+        }
+        std::cout << (enabled ? "Resuming" : "Pausing") << " accepts (overload: "
+                  << overload_level_name(overload.get_level()) << ", "
+                  << client_connections.size() << " connections)." << std::endl;
+
+        // EPOLLEXCLUSIVE registrations cannot be modified, so listeners
+        // leave epoll and rejoin it instead.
+        for (const scoped_file_descriptor &listener : listener_fds)
+        {
+            if (enabled)
             {
-                message_text = command_line.substr(5);
+                register_descriptor(listener.get(), listener_events());
             }
             else
             {
-                response_str = "ERR: Invalid POST format. Usage: POST "
-                               "<message>\n";
-                queue_data_for_send(client, std::move(response_str));
-                return;
+                unregister_descriptor(listener.get());
             }
-            std::lock_guard<std::mutex> lock(messages_mutex);
-            uintmax_t                   current_id = next_message_id++;
-            messages.push_back(
-                { current_id, message_text, client.get_ip_string(), "" }
-            );
-            response_str = "OK: Message " + std::to_string(current_id)
-                         + " posted.\n";
         }
-        else if (command_token == "GET")
+        if (enabled)
         {
-            std::lock_guard<std::mutex> lock(messages_mutex);
-            if (messages.empty())
+            // Edge-triggered: connections that queued up meanwhile raise no
+            // new event.
+            for (const scoped_file_descriptor &listener : listener_fds)
             {
-                response_str = "Stack is empty.\n";
+                accept_new_connections(listener.get());
             }
-            else
+        }
+    }
+
+    auto server::listener_events(void) const -> uint32_t
+    {
+        uint32_t events = EPOLLIN | EPOLLET;
+        if (options.distribution == listener_distribution::exclusive)
+        {
+            events |= static_cast<uint32_t>(EPOLLEXCLUSIVE);
+        }
+        return events;
+    }
+
+    auto server::update_overload(std::chrono::steady_clock::duration loop_lag) -> void
+    {
+        overload.record_loop_lag(loop_lag);
+
+        auto now = std::chrono::steady_clock::now();
+        if (overload.sample_due(now))
+        {
+            overload_level previous = overload.get_level();
+            if (overload.update(buffered_bytes, now) != previous)
             {
-                std::ostringstream oss_resp;
-                for (const auto &msg_item : messages)
-                {
-                    oss_resp
-                        << "ID: " << msg_item.id
-                        << ", From: " << msg_item.sender_ip << ", Reaction: ["
-                        << (msg_item.reaction.empty() ? "" : msg_item.reaction)
-                        << "]"
-                        << ", Msg: \"" << msg_item.text << "\"\n";
-                }
-                response_str = oss_resp.str();
+                std::cout << "Overload level "
+                          << overload_level_name(overload.get_level())
+                          << " (loop lag " << overload.get_smoothed_lag().count()
+                          << "us, " << buffered_bytes << " bytes buffered)." << std::endl;
             }
         }
-        else if (command_token == "HAPPY" || command_token == "SAD")
+
+        set_accepting(
+            overload.get_level() == overload_level::normal && !at_connection_limit()
+            && !is_handing_off() && !draining
+        );
+    }
+
+    auto server::consume_input(client_connection &client, size_t count) -> void
+    {
+        client.get_read_buffer().erase(0, count);
+        buffered_bytes -= count;
+    }
+
+    auto server::is_shedding(void) const -> bool
+    {
+        return overload.get_level() == overload_level::shedding;
+    }
+
+    auto server::connection_trace(const client_connection &client) -> trace_recorder *
+    {
+        return client.is_traced() ? tracer.get() : nullptr;
+    }
+
+    auto parse_get_filter(std::istream &arguments)
+        -> std::expected<message_filter, std::string>
+    {
+        static constexpr const char usage[]
+            = "ERR: Invalid GET format. Usage: GET [FROM <ip>] "
+              "[REACTION <HAPPY|SAD|NONE>] [AFTER <id>] [LIMIT <n>] "
+              "[IFCHANGED <version>]\n";
+
+        message_filter filter;
+        std::string    keyword;
+        while (arguments >> keyword)
         {
-            std::string id_str_cmd;
-            iss_cmd >> id_str_cmd;
-            if (id_str_cmd.empty())
+            std::string argument;
+            if (!(arguments >> argument))
             {
-                response_str = "ERR: Message ID not provided for "
-                             + command_token + ".\n";
+                return std::unexpected(usage);
             }
-            else
+
+            if (keyword == "FROM")
             {
-                uintmax_t message_id_val;
-                auto [ptr_cmd, ec_cmd] = std::from_chars(
-                    id_str_cmd.data(),
-                    id_str_cmd.data() + id_str_cmd.size(),
-                    message_id_val
-                );
-                if (ec_cmd == std::errc()
-                    && ptr_cmd == id_str_cmd.data() + id_str_cmd.size())
-                {
-                    std::lock_guard<std::mutex> lock(messages_mutex);
-                    auto                        it_msg = std::find_if(
-                        messages.begin(),
-                        messages.end(),
-                        [message_id_val](const message &m)
-                        {
-                            return m.id == message_id_val;
-                        }
-                    );
-                    if (it_msg != messages.end())
-                    {
-                        it_msg->reaction = command_token;
-                        response_str     = "OK: Reaction set for message "
-                                     + std::to_string(message_id_val) + ".\n";
-                    }
-                    else
-                    {
-                        response_str
-                            = "ERR: Message ID "
-                            + std::to_string(message_id_val) + " not found.\n";
-                    }
+                filter.sender_ip = argument;
+            }
+            else if (keyword == "REACTION")
+            {
+                if (argument != "HAPPY" && argument != "SAD"
+                    && argument != "NONE")
+                {
+                    return std::unexpected(usage);
                 }
-                else
+                filter.reaction = argument == "NONE" ? "" : argument;
+            }
+            else if (keyword == "AFTER")
+            {
+                filter.after_id = parse_unsigned(argument);
+                if (!filter.after_id)
                 {
-                    response_str = "ERR: Invalid message ID format '"
-                                 + id_str_cmd + "'. Must be an integer.\n";
+                    return std::unexpected(usage);
                 }
             }
-        }
-        else
-        {
-            if (!command_token.empty())
+            else if (keyword == "LIMIT")
+            {
+                auto limit = parse_unsigned(argument);
+                if (!limit || *limit == 0)
+                {
+                    return std::unexpected(usage);
+                }
+                filter.limit = *limit;
+            }
+            else if (keyword == "IFCHANGED")
+            {
+                filter.if_changed_since = parse_unsigned(argument);
+                if (!filter.if_changed_since)
+                {
+                    return std::unexpected(usage);
+                }
+            }
+            else
             {
-                response_str = "ERR: Unknown command '" + command_token + "'.\n";
+                return std::unexpected(usage);
             }
         }
 
-        if (!response_str.empty())
-        {
-            queue_data_for_send(client, std::move(response_str));
-        }
+        return filter;
     }
 
-    auto server::queue_data_for_send(
-        client_connection &client,
-        std::string        data_to_send
-    ) -> void
+    namespace
     {
-        client.get_write_buffer().append(std::move(data_to_send));
-
-        if (!client.is_writing_registered() && !client.get_write_buffer().empty())
+        // Prefixes every response line with "#<tag> " so pipelining clients
+        // can correlate responses with the request that produced them.
+        auto tag_response(const std::string &tag, std::string response)
+            -> std::string
         {
-            ssize_t sent_bytes = send(
-                client.get_fd(),
-                client.get_write_buffer().data(),
-                client.get_write_buffer().length(),
-                MSG_NOSIGNAL
-            );
-            if (sent_bytes >= 0)
+            if (tag.empty() || response.empty())
             {
-                client.get_write_buffer().erase(0, sent_bytes);
-            }
-            else
-            { // sent_bytes == -1
-                if (errno != EAGAIN && errno != EWOULDBLOCK)
-                {
-                    close_client(
-                        client.get_fd(),
-                        make_errno_message("send error").c_str()
-                    );
-                    return;
-                }
+                return response;
             }
-        }
 
-        if (!client.get_write_buffer().empty() && !client.is_writing_registered())
-        {
-            auto mod_result
-                = modify_descriptor(client.get_fd(), EPOLLIN | EPOLLOUT | EPOLLET);
-            if (!mod_result.has_value())
+            std::string tagged;
+            tagged.reserve(response.size() + tag.size() + 2);
+            size_t line_start = 0;
+            while (line_start < response.size())
             {
-                close_client(client.get_fd(), "epoll_modify for EPOLLOUT failed");
-                return;
+                size_t line_end = response.find('\n', line_start);
+                line_end        = line_end == std::string::npos
+                                    ? response.size()
+                                    : line_end + 1;
+                tagged.append("#").append(tag).append(" ");
+                tagged.append(response, line_start, line_end - line_start);
+                line_start = line_end;
             }
-            client.is_writing_registered() = true;
+
+            return tagged;
         }
     }
 
-    auto server::handle_client_read(client_connection &client) -> void
+    auto server::execute_store_command(
+        const std::string &sender_ip,
+        const std::string &command_line
+    ) -> std::string
     {
-        char buffer[BUFFER_SIZE];
-        bool client_alive = true;
+        std::istringstream iss_cmd(command_line);
+        std::string        command_token;
+        iss_cmd >> command_token;
 
-        while (true)
+        if (command_token == "POST")
         {
-            ssize_t bytes_received
-                = recv(client.get_fd(), buffer, sizeof(buffer), 0);
-            if (bytes_received > 0)
+            if (command_line.rfind("POST ", 0) != 0)
             {
-                client.get_read_buffer().append(buffer, bytes_received);
+                return "ERR: Invalid POST format. Usage: POST <message>\n";
             }
-            else if (bytes_received == 0)
+            if (is_follower())
             {
-                close_client(client.get_fd(), "client disconnected");
-                client_alive = false;
-                break;
+                return read_only_error();
             }
-            else
-            { // bytes_received == -1
-                if (errno == EAGAIN || errno == EWOULDBLOCK)
-                    break;
-                close_client(
-                    client.get_fd(),
-                    make_errno_message("recv error").c_str()
-                );
-                client_alive = false;
-                break;
+            auto text = normalize_message_text(
+                std::string_view(command_line).substr(5),
+                options.max_message_length
+            );
+            if (!text)
+            {
+                return text.error();
             }
+            uintmax_t current_id = store.post(std::move(*text), sender_ip);
+            return "OK: Message " + std::to_string(current_id) + " posted.\n";
         }
-
-        if (!client_alive)
-            return;
-
-        std::string &accumulated_data = client.get_read_buffer();
-        size_t       newline_pos;
-        while ((newline_pos = accumulated_data.find('\n')) != std::string::npos)
+        if (command_token == "GET")
         {
-            std::string command_line = accumulated_data.substr(0, newline_pos);
-            accumulated_data.erase(0, newline_pos + 1);
-            command_line = trim(command_line);
-
-            if (!command_line.empty())
+            auto filter = parse_get_filter(iss_cmd);
+            if (!filter)
             {
-                process_client_command(client, command_line);
+                return filter.error();
             }
+            return store.render(*filter);
         }
-    }
-
-    auto server::handle_client_write(client_connection &client) -> void
-    {
-        if (client.get_write_buffer().empty())
+        if (command_token == "SEARCH")
         {
-            if (client.is_writing_registered())
+            std::string term;
+            iss_cmd >> term;
+            if (term.empty())
             {
-                modify_descriptor(client.get_fd(), EPOLLIN | EPOLLET);
-                client.is_writing_registered() = false;
+                return "ERR: Invalid SEARCH format. Usage: SEARCH <term> "
+                       "[limit]\n";
             }
-            return;
+
+            size_t limit = DEFAULT_SEARCH_LIMIT;
+            if (std::string limit_str; iss_cmd >> limit_str)
+            {
+                auto parsed_limit = parse_unsigned(limit_str);
+                if (!parsed_limit || *parsed_limit == 0
+                    || *parsed_limit > MAX_SEARCH_LIMIT)
+                {
+                    return "ERR: Invalid SEARCH limit '" + limit_str
+                         + "'. Must be 1-" + std::to_string(MAX_SEARCH_LIMIT)
+                         + ".\n";
+                }
+                limit = *parsed_limit;
+            }
+            // Stored text is escaped, so the term must be too, or a '"' or
+            // '\\' in it could never match.
+            auto escaped_term = normalize_message_text(term, options.max_message_length);
+            if (!escaped_term)
+            {
+                return "ERR: Invalid SEARCH term. Terms follow the rules for "
+                       "message text.\n";
+            }
+            return store.search(*escaped_term, limit);
         }
+        if (command_token == "HAPPY" || command_token == "SAD")
+        {
+            std::string id_str_cmd;
+            iss_cmd >> id_str_cmd;
+            if (id_str_cmd.empty())
+            {
+                return "ERR: Message ID not provided for " + command_token
+                     + ".\n";
+            }
 
-        ssize_t bytes_sent = send(
-            client.get_fd(),
-            client.get_write_buffer().data(),
-            client.get_write_buffer().length(),
-            MSG_NOSIGNAL
-        );
+            uintmax_t message_id_val;
+            auto [ptr_cmd, ec_cmd] = std::from_chars(
+                id_str_cmd.data(),
+                id_str_cmd.data() + id_str_cmd.size(),
+                message_id_val
+            );
+            if (ec_cmd != std::errc()
+                || ptr_cmd != id_str_cmd.data() + id_str_cmd.size())
+            {
+                return "ERR: Invalid message ID format '" + id_str_cmd
+                     + "'. Must be an integer.\n";
+            }
 
-        if (bytes_sent >= 0)
-        {
-            client.get_write_buffer().erase(0, bytes_sent);
-            if (client.get_write_buffer().empty()
-                && client.is_writing_registered())
+            if (is_follower())
             {
-                modify_descriptor(client.get_fd(), EPOLLIN | EPOLLET);
-                client.is_writing_registered() = false;
+                return read_only_error();
             }
-        }
-        else
-        { // bytes_sent == -1
-            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            auto react_result = store.react(message_id_val, command_token);
+            if (!react_result)
             {
-                close_client(
-                    client.get_fd(),
-                    make_errno_message("send error").c_str()
-                );
+                return react_result.error();
             }
+            return "OK: Reaction set for message "
+                 + std::to_string(message_id_val) + ".\n";
+        }
+        if (!command_token.empty())
+        {
+            return "ERR: Unknown command '" + command_token + "'.\n";
         }
+
+        return "";
     }
 
-    auto server::make(uint16_t port, int backlog)
-        -> std::expected<server, std::string>
+    auto server::process_client_command(
+        client_connection &client,
+        const std::string &command_line
+    ) -> task<>
     {
-        // Step 1: Setup socket
-        std::expected<scoped_file_descriptor, std::string> server_socket_fd_expected
-            = [&]() -> std::expected<scoped_file_descriptor, std::string>
+        if (client.get_pending_batch().kind != batch_kind::none)
         {
-            scoped_file_descriptor fd(socket(AF_INET, SOCK_STREAM, 0));
-            if (fd.get() == -1)
-                return std::unexpected(make_errno_message("socket() failed"));
-            return fd;
-        }();
-        if (!server_socket_fd_expected)
+            co_await collect_batch_line(client, command_line);
+            co_return;
+        }
+
+        if (options.log_connections)
         {
-            return std::unexpected(server_socket_fd_expected.error());
+            std::cout << "Processing for " << client.get_peer_string() << " (socket "
+                      << client.get_fd() << "): " << command_line << std::endl;
         }
-        scoped_file_descriptor server_socket_fd
-            = std::move(server_socket_fd_expected.value());
 
-        // Step 2: Configure socket
-        auto configure_res = [&](scoped_file_descriptor fd)
-            -> std::expected<scoped_file_descriptor, std::string>
+        // Optional "#<tag> " prefix for pipelined request correlation.
+        std::string tag;
+        std::string command_body = command_line;
+        if (command_line.front() == '#')
         {
-            int option_value = 1;
-            if (setsockopt(
-                    fd.get(),
-                    SOL_SOCKET,
-                    SO_REUSEADDR,
-                    &option_value,
-                    sizeof(option_value)
+            size_t tag_end = command_line.find(' ');
+            tag            = command_line.substr(
+                1,
+                tag_end == std::string::npos ? std::string::npos : tag_end - 1
+            );
+            command_body = tag_end == std::string::npos
+                             ? ""
+                             : trim(command_line.substr(tag_end + 1));
+            if (tag.empty() || command_body.empty())
+            {
+                queue_data_for_send(
+                    client,
+                    "ERR: Invalid tag format. Usage: #<tag> <command>\n"
+                );
+                co_return;
+            }
+        }
+
+        std::istringstream iss_cmd(command_body);
+        std::string        command_token;
+        iss_cmd >> command_token;
+
+        trace_recorder *trace = connection_trace(client);
+        trace_span      command_span(trace, "command", client.get_fd());
+        command_span.set_detail(command_token);
+
+        // Refuse work cheaply while overloaded; STATS stays available so
+        // operators can see why.
+        if (is_shedding() && command_token != "STATS")
+        {
+            ++loop_stats.shed_commands;
+            queue_data_for_send(client, tag_response(tag, std::string(OVERLOAD_REPLY)));
+            co_return;
+        }
+
+        if (is_router() && command_token != "STATS" && command_token != "COMPRESS"
+            && command_token != "MPOST")
+        {
+            int        client_fd = client.get_fd();
+            trace_span route_span(trace, "route", client_fd);
+            std::string routed_reply
+                = co_await route_command(client, command_token, command_body);
+            route_span.end();
+            if (client_connections.contains(client_fd))
+            {
+                queue_data_for_send(client, tag_response(tag, std::move(routed_reply)));
+            }
+            co_return;
+        }
+
+        std::string response_str;
+        if (command_token == "MPOST")
+        {
+            size_t count = 0;
+            if (is_follower())
+            {
+                response_str = read_only_error();
+            }
+            else if (!(iss_cmd >> count) || count == 0 || count > MAX_BATCH_SIZE)
+            {
+                response_str = "ERR: Invalid MPOST format. Usage: MPOST <n> "
+                               "(1-"
+                             + std::to_string(MAX_BATCH_SIZE) + ")\n";
+            }
+            else
+            {
+                pending_batch &batch = client.get_pending_batch();
+                batch.kind           = batch_kind::mpost;
+                batch.remaining      = count;
+                batch.tag            = std::move(tag);
+                batch.lines.reserve(count);
+                co_return;
+            }
+        }
+        else if (command_token == "BATCH")
+        {
+            pending_batch &batch = client.get_pending_batch();
+            batch.kind           = batch_kind::batch;
+            batch.tag            = std::move(tag);
+            co_return;
+        }
+        else if (command_token == REPLICATE_COMMAND)
+        {
+            std::string sequence_str;
+            iss_cmd >> sequence_str;
+            auto from_sequence = parse_unsigned(sequence_str);
+            if (!from_sequence)
+            {
+                response_str = "ERR: Invalid REPLICATE format. Usage: REPLICATE "
+                               "<sequence>\n";
+            }
+            else
+            {
+                subscribe_replica(client, *from_sequence);
+                co_return;
+            }
+        }
+        else if (command_token == "COMPRESS")
+        {
+            std::string mode_str;
+            iss_cmd >> mode_str;
+            if (mode_str == "OFF")
+            {
+                response_str = "OK: Compression disabled.\n";
+                client.set_compression_mode(compression_mode::none);
+            }
+            else if (mode_str == "DEFLATE" && compression_available())
+            {
+                // The acknowledgement is the last uncompressed response.
+                queue_data_for_send(client, "OK: Compression enabled.\n");
+                client.set_compression_mode(compression_mode::deflate);
+                co_return;
+            }
+            else if (mode_str == "DEFLATE")
+            {
+                response_str = "ERR: Compression not supported by this build.\n";
+            }
+            else
+            {
+                response_str = "ERR: Invalid COMPRESS format. Usage: COMPRESS "
+                               "<DEFLATE|OFF>\n";
+            }
+        }
+        else if (command_token == "GET" && tag.empty()
+                 && client.get_compression_mode() != compression_mode::none
+                 && command_body == "GET")
+        {
+            int         client_fd = client.get_fd();
+            trace_span  render_span(trace, "render", client_fd);
+            std::string frame = co_await serve_compressed_get(client);
+            render_span.end();
+            if (client_connections.contains(client_fd))
+            {
+                queue_raw_for_send(client, std::move(frame));
+            }
+            co_return;
+        }
+        else if (command_token == "GET")
+        {
+            auto filter = parse_get_filter(iss_cmd);
+            if (!filter)
+            {
+                response_str = filter.error();
+            }
+            else
+            {
+                int        client_fd = client.get_fd();
+                trace_span render_span(trace, "render", client_fd);
+                response_str = co_await serve_get(client, *filter);
+                render_span.end();
+                if (!client_connections.contains(client_fd))
+                {
+                    co_return;
+                }
+            }
+        }
+        else if (command_token == "STATS")
+        {
+            response_str = render_stats();
+        }
+        else if (command_token == BINARY_HANDSHAKE_LINE)
+        {
+            // Everything after the handshake line is parsed as binary frames.
+            client.set_protocol_mode(protocol_mode::binary);
+            response_str = "OK: Binary protocol enabled.\n";
+        }
+        else
+        {
+            trace_span lock_span(trace, "lock_wait", client.get_fd());
+            auto       lock = store.lock();
+            lock_span.end();
+            trace_span execute_span(trace, "execute", client.get_fd());
+            response_str = execute_store_command(client.get_peer_string(), command_body);
+        }
+
+        if (!response_str.empty())
+        {
+            trace_span queue_span(trace, "queue", client.get_fd());
+            queue_data_for_send(client, tag_response(tag, std::move(response_str)));
+        }
+    }
+
+    auto server::collect_batch_line(
+        client_connection &client,
+        const std::string &line
+    ) -> task<>
+    {
+        pending_batch &batch = client.get_pending_batch();
+
+        if (batch.kind == batch_kind::mpost)
+        {
+            batch.lines.push_back(line);
+            if (--batch.remaining == 0)
+            {
+                co_await complete_batch(client);
+            }
+            co_return;
+        }
+
+        if (batch.kind == batch_kind::discard)
+        {
+            if (line == "END")
+            {
+                batch = pending_batch {};
+            }
+            co_return;
+        }
+        if (line == "END")
+        {
+            co_await complete_batch(client);
+            co_return;
+        }
+        if (batch.lines.size() >= MAX_BATCH_SIZE)
+        {
+            // The rest of the batch must not run as separate commands.
+            std::string tag = std::move(batch.tag);
+            batch           = pending_batch {};
+            batch.kind      = batch_kind::discard;
+            queue_data_for_send(
+                client,
+                tag_response(
+                    tag,
+                    "ERR: BATCH exceeds " + std::to_string(MAX_BATCH_SIZE)
+                        + " commands; discarded.\n"
                 )
-                == -1)
+            );
+            co_return;
+        }
+        batch.lines.push_back(line);
+    }
+
+    auto server::normalize_batch(std::span<const std::string> texts)
+        -> std::expected<std::vector<std::string>, std::string>
+    {
+        std::vector<std::string> normalized;
+        normalized.reserve(texts.size());
+        for (size_t index = 0; index < texts.size(); ++index)
+        {
+            if (texts[index].empty())
             {
-                return std::unexpected(make_errno_message("setsockopt(SO_"
-                                                          "REUSEADDR) failed"));
+                return std::unexpected(
+                    "ERR: Batch message " + std::to_string(index + 1)
+                    + ": Message is empty.\n"
+                );
             }
-            if (auto result = make_socket_non_blocking(fd.get()); !result)
-            { // Check has_value() implicitly
-                return std::unexpected(result.error());
+            auto text = normalize_message_text(texts[index], options.max_message_length);
+            if (!text)
+            {
+                // "ERR: <reason>" -> "ERR: Batch message <n>: <reason>"
+                return std::unexpected(
+                    "ERR: Batch message " + std::to_string(index + 1) + ": "
+                    + text.error().substr(5)
+                );
+            }
+            normalized.push_back(std::move(*text));
+        }
+        return normalized;
+    }
+
+    auto server::complete_batch(client_connection &client) -> task<>
+    {
+        pending_batch batch = std::move(client.get_pending_batch());
+        client.get_pending_batch() = pending_batch {};
+
+        if (options.log_connections)
+        {
+            std::cout << "Processing batch of " << batch.lines.size() << " for "
+                      << client.get_peer_string() << " (socket " << client.get_fd()
+                      << ")" << std::endl;
+        }
+
+        // A batch is posted as one ID range, so one bad line rejects it all.
+        std::string response_str;
+        if (is_router())
+        {
+            // Routers only collect MPOST; the owning shard normalizes the raw
+            // lines and posts the range.
+            int client_fd = client.get_fd();
+            response_str  = co_await route_batch(client, batch.lines);
+            if (!client_connections.contains(client_fd))
+            {
+                co_return;
+            }
+        }
+        else
+        {
+            if (batch.kind == batch_kind::mpost)
+            {
+                auto texts = normalize_batch(batch.lines);
+                if (!texts)
+                {
+                    queue_data_for_send(client, tag_response(batch.tag, texts.error()));
+                    co_return;
+                }
+                batch.lines = std::move(*texts);
+            }
+            auto lock = store.lock();
+            if (batch.kind == batch_kind::mpost)
+            {
+                uintmax_t first_id
+                    = store.post_batch(batch.lines, client.get_peer_string());
+                response_str = posted_range_reply(first_id, batch.lines.size());
+            }
+            else
+            {
+                // GETs only take their snapshot under the batch's lock, so
+                // each sees exactly the lines before it, and render
+                // afterwards the way a plain GET does.
+                std::vector<std::string> replies(batch.lines.size());
+                std::vector<std::pair<size_t, message_snapshot>> gets;
+                for (size_t index = 0; index < batch.lines.size(); ++index)
+                {
+                    std::istringstream arguments(batch.lines[index]);
+                    std::string        command_token;
+                    arguments >> command_token;
+                    if (command_token != "GET")
+                    {
+                        replies[index] = execute_store_command(
+                            client.get_peer_string(),
+                            batch.lines[index]
+                        );
+                        continue;
+                    }
+                    auto filter = parse_get_filter(arguments);
+                    if (!filter)
+                    {
+                        replies[index] = filter.error();
+                        continue;
+                    }
+                    gets.emplace_back(index, store.snapshot(*filter));
+                }
+                lock.unlock();
+
+                int client_fd = client.get_fd();
+                for (auto &[index, snapshot] : gets)
+                {
+                    replies[index] = co_await render_snapshot(client, std::move(snapshot));
+                    if (!client_connections.contains(client_fd))
+                    {
+                        co_return;
+                    }
+                }
+                for (std::string &reply : replies)
+                {
+                    response_str += reply;
+                }
+            }
+        }
+
+        if (!response_str.empty())
+        {
+            queue_data_for_send(
+                client,
+                tag_response(batch.tag, std::move(response_str))
+            );
+        }
+    }
+
+    auto server::posted_range_reply(uintmax_t first_id, size_t count) const
+        -> std::string
+    {
+        uintmax_t last_id = first_id + (count - 1) * store.get_id_stride();
+        return "OK: Messages " + std::to_string(first_id) + "-"
+             + std::to_string(last_id) + " posted.\n";
+    }
+
+    auto server::process_binary_frame(
+        client_connection         &client,
+        const binary_frame_header &header,
+        std::string_view           payload
+    ) -> task<>
+    {
+        trace_span frame_span(connection_trace(client), "frame", client.get_fd());
+        frame_span.set_detail(binary_opcode_name(header.opcode));
+
+        auto reply = [&](binary_status status, std::string_view reply_payload)
+        {
+            queue_data_for_send(
+                client,
+                encode_binary_frame(
+                    header.opcode,
+                    status,
+                    header.request_id,
+                    reply_payload
+                )
+            );
+        };
+
+        if (is_shedding())
+        {
+            ++loop_stats.shed_commands;
+            reply(binary_status::error, OVERLOAD_REPLY);
+            co_return;
+        }
+
+        bool is_write = header.opcode == binary_opcode::post
+                     || header.opcode == binary_opcode::post_batch
+                     || header.opcode == binary_opcode::happy
+                     || header.opcode == binary_opcode::sad;
+        if (is_write && is_follower())
+        {
+            reply(binary_status::error, read_only_error());
+            co_return;
+        }
+
+        switch (header.opcode)
+        {
+            case binary_opcode::post:
+                {
+                    auto text
+                        = normalize_message_text(payload, options.max_message_length);
+                    if (!text)
+                    {
+                        reply(binary_status::error, text.error());
+                        co_return;
+                    }
+                    uintmax_t current_id;
+                    {
+                        auto lock  = store.lock();
+                        current_id = store.post(
+                            std::move(*text),
+                            client.get_peer_string()
+                        );
+                    }
+                    reply(binary_status::ok, encode_binary_id(current_id));
+                    co_return;
+                }
+
+            case binary_opcode::post_batch:
+                {
+                    auto texts = decode_binary_batch(payload);
+                    if (!texts || texts->empty() || texts->size() > MAX_BATCH_SIZE)
+                    {
+                        reply(
+                            binary_status::error,
+                            "ERR: Malformed or oversized batch payload.\n"
+                        );
+                        co_return;
+                    }
+                    auto normalized = normalize_batch(*texts);
+                    if (!normalized)
+                    {
+                        reply(binary_status::error, normalized.error());
+                        co_return;
+                    }
+                    uintmax_t first_id;
+                    {
+                        auto lock = store.lock();
+                        first_id
+                            = store.post_batch(*normalized, client.get_peer_string());
+                    }
+                    reply(binary_status::ok, encode_binary_id(first_id));
+                    co_return;
+                }
+
+            case binary_opcode::get:
+                {
+                    if (!payload.empty() && payload.size() != sizeof(uint64_t))
+                    {
+                        reply(
+                            binary_status::error,
+                            "ERR: GET payload must be empty or a 64-bit board "
+                            "version.\n"
+                        );
+                        co_return;
+                    }
+                    message_filter filter;
+                    if (!payload.empty())
+                    {
+                        filter.if_changed_since = load_le64(payload.data());
+                    }
+                    int         client_fd = client.get_fd();
+                    std::string rendered  = co_await serve_get(client, filter);
+                    if (client_connections.contains(client_fd))
+                    {
+                        reply(binary_status::ok, rendered);
+                    }
+                    co_return;
+                }
+
+            case binary_opcode::happy:
+            case binary_opcode::sad:
+                {
+                    if (payload.size() != sizeof(uint64_t))
+                    {
+                        reply(
+                            binary_status::error,
+                            "ERR: Reaction payload must be a 64-bit message "
+                            "ID.\n"
+                        );
+                        co_return;
+                    }
+                    uint64_t message_id = load_le64(payload.data());
+                    std::expected<void, std::string> react_result;
+                    {
+                        auto lock    = store.lock();
+                        react_result = store.react(
+                            message_id,
+                            header.opcode == binary_opcode::happy ? "HAPPY"
+                                                                  : "SAD"
+                        );
+                    }
+                    if (!react_result)
+                    {
+                        reply(binary_status::error, react_result.error());
+                        co_return;
+                    }
+                    reply(binary_status::ok, encode_binary_id(message_id));
+                    co_return;
+                }
+
+            case binary_opcode::routed:
+                {
+                    auto routed = decode_routed_command(payload);
+                    if (!options.shard_index)
+                    {
+                        reply(
+                            binary_status::error,
+                            "ERR: Routed commands are only accepted by shard "
+                            "nodes.\n"
+                        );
+                        co_return;
+                    }
+                    if (!client.is_router_peer())
+                    {
+                        reply(
+                            binary_status::error,
+                            "ERR: Routed commands are only accepted from this "
+                            "node's router.\n"
+                        );
+                        co_return;
+                    }
+                    if (!routed)
+                    {
+                        reply(binary_status::error, "ERR: Malformed routed command.\n");
+                        co_return;
+                    }
+                    int         client_fd = client.get_fd();
+                    std::string response  = co_await run_routed_command(
+                        client,
+                        std::string(routed->sender_ip),
+                        routed->command
+                    );
+                    if (client_connections.contains(client_fd))
+                    {
+                        reply(binary_status::ok, response);
+                    }
+                    co_return;
+                }
+
+            case binary_opcode::router_hello:
+                {
+                    if (!options.shard_index
+                        || !cluster_secret_matches(payload, options.cluster_secret))
+                    {
+                        close_client(client.get_fd(), "not accepted as a router");
+                        co_return;
+                    }
+                    client.set_router_peer(true);
+                    reply(binary_status::ok, "");
+                    co_return;
+                }
+        }
+
+        reply(binary_status::error, "ERR: Unknown binary opcode.\n");
+    }
+
+    auto server::drain_read_buffer(client_connection &client) -> task<>
+    {
+        int            client_fd        = client.get_fd();
+        pooled_string &accumulated_data = client.get_read_buffer();
+
+        // A command may close the client, so re-check ownership after each
+        // one before touching the connection again.
+        auto client_alive = [&](void)
+        {
+            return client_connections.contains(client_fd);
+        };
+
+        // Consume complete lines by offset and compact the buffer once. The
+        // buffer may grow while a command is suspended, so only offsets are
+        // kept across a co_await. Before waiting for a slow reader the
+        // buffer is compacted, so a suspended connection never holds
+        // commands it has already run.
+        auto output_backed_up = [&](void)
+        {
+            return client.get_write_buffer().size() >= CONNECTION_OUTPUT_HIGH_WATER;
+        };
+        size_t consumed = 0;
+        while (client.get_protocol_mode() == protocol_mode::text)
+        {
+            size_t newline_pos = accumulated_data.find('\n', consumed);
+            if (newline_pos == std::string::npos)
+            {
+                break;
+            }
+            std::string command_line(
+                accumulated_data.data() + consumed,
+                newline_pos - consumed
+            );
+            consumed = newline_pos + 1;
+
+            // MPOST payload lines are messages, not commands: each one
+            // counts, blank or not, so the reply lines up with the posts.
+            // Only a CRLF's '\r' is dropped.
+            bool payload_line = client.get_pending_batch().kind == batch_kind::mpost;
+            if (!payload_line)
+            {
+                command_line = trim(command_line);
+            }
+            else if (command_line.ends_with('\r'))
+            {
+                command_line.pop_back();
+            }
+
+            if (payload_line || !command_line.empty())
+            {
+                if (recorder)
+                {
+                    recorder->record(client, traffic_kind::text, command_line);
+                }
+                OREORE_PROBE2(command__start, client_fd, command_line.c_str());
+                co_await process_client_command(client, command_line);
+                OREORE_PROBE1(command__end, client_fd);
+                if (!client_alive())
+                {
+                    co_return;
+                }
+                if (output_backed_up())
+                {
+                    consume_input(client, std::exchange(consumed, 0));
+                    co_await flush(client);
+                    if (!client_alive())
+                    {
+                        co_return;
+                    }
+                }
+            }
+        }
+        consume_input(client, consumed);
+        if (client.get_protocol_mode() == protocol_mode::text)
+        {
+            co_return;
+        }
+
+        consumed = 0;
+        while (true)
+        {
+            std::string_view pending(accumulated_data);
+            pending.remove_prefix(consumed);
+
+            auto header = decode_binary_header(pending);
+            if (!header)
+            {
+                break;
+            }
+            if (header->payload_length > MAX_BINARY_PAYLOAD_SIZE)
+            {
+                close_client(client_fd, "binary frame too large");
+                co_return;
+            }
+            if (pending.size() < BINARY_HEADER_SIZE + header->payload_length)
+            {
+                break;
+            }
+
+            if (recorder)
+            {
+                recorder->record(
+                    client,
+                    traffic_kind::frame,
+                    pending.substr(0, BINARY_HEADER_SIZE + header->payload_length)
+                );
+            }
+            OREORE_PROBE3(
+                frame__start,
+                client_fd,
+                static_cast<uint8_t>(header->opcode),
+                header->request_id
+            );
+            co_await process_binary_frame(
+                client,
+                *header,
+                pending.substr(BINARY_HEADER_SIZE, header->payload_length)
+            );
+            OREORE_PROBE2(frame__end, client_fd, header->request_id);
+            if (!client_alive())
+            {
+                co_return;
+            }
+            consumed += BINARY_HEADER_SIZE + header->payload_length;
+            if (output_backed_up())
+            {
+                consume_input(client, std::exchange(consumed, 0));
+                co_await flush(client);
+                if (!client_alive())
+                {
+                    co_return;
+                }
+            }
+        }
+        consume_input(client, consumed);
+    }
+
+    auto server::queue_data_for_send(
+        client_connection &client,
+        std::string        data_to_send
+    ) -> void
+    {
+        if (client.get_compression_mode() != compression_mode::none)
+        {
+            data_to_send
+                = make_compressed_frame(data_to_send, COMPRESSION_FAST_LEVEL);
+        }
+        queue_raw_for_send(client, std::move(data_to_send));
+    }
+
+    auto server::render_stats(void) -> std::string
+    {
+        std::string stats;
+        auto        add_line = [&stats](std::string_view key, auto value)
+        {
+            stats.append(key).append(": ");
+            stats.append(std::to_string(value)).append("\n");
+        };
+
+        add_line("listeners", listener_fds.size());
+        add_line("loop.busy_polls", loop_stats.busy_polls);
+        add_line("loop.blocking_waits", loop_stats.blocking_waits);
+        add_line("render.workers", options.render_workers);
+        add_line("render.offloaded", loop_stats.offloaded_renders);
+        stats.append("overload.level: ")
+            .append(overload_level_name(overload.get_level()))
+            .append("\n");
+        add_line("overload.loop_lag_us", overload.get_smoothed_lag().count());
+        add_line("overload.buffered_bytes", overload.get_buffered_bytes());
+        add_line("overload.shed_commands", loop_stats.shed_commands);
+        add_line("overload.accept_pauses", loop_stats.accept_pauses);
+        add_line("accepting", static_cast<int>(accepting));
+        add_line("connections", client_connections.size());
+        add_line("replica_subscribers", replica_subscribers.size());
+        if (recorder)
+        {
+            add_line("record.commands", recorder->get_recorded_commands());
+        }
+        if (options.shard_index)
+        {
+            add_line("cluster.shard", *options.shard_index);
+        }
+        if (is_router())
+        {
+            add_line("cluster.shards", shard_links.size());
+            for (size_t shard = 0; shard < shard_links.size(); ++shard)
+            {
+                add_line(
+                    "cluster.shard." + std::to_string(shard) + ".connected",
+                    static_cast<int>(shard_links[shard].is_connected())
+                );
+            }
+            add_line("cluster.pending_requests", shard_waiters.size());
+        }
+        {
+            auto lock = store.lock();
+            add_line("board_version", store.event_count());
+        }
+        if (board_mirror)
+        {
+            add_line("shm.used_bytes", board_mirror->get_used_bytes());
+            add_line("shm.truncated", static_cast<int>(board_mirror->is_truncated()));
+        }
+        stats.append("text.scanner: ").append(message_text_scanner()).append("\n");
+        add_line("text.max_message_bytes", options.max_message_length);
+
+        buffer_pool_stats pool = buffer_pool::local().get_stats();
+        add_line("pool.slabs", pool.slab_count);
+        add_line("pool.reserved_bytes", pool.reserved_bytes);
+        add_line("pool.huge_pages", static_cast<int>(pool.huge_pages));
+        for (const auto &size_class : pool.classes)
+        {
+            std::string prefix
+                = "pool.class." + std::to_string(size_class.block_size);
+            add_line(prefix + ".in_use", size_class.in_use);
+            add_line(prefix + ".free", size_class.free);
+        }
+        add_line("pool.oversize_in_use", pool.oversize_in_use);
+
+        return stats;
+    }
+
+    auto server::publish_shared_board(void) -> void
+    {
+        // Runs every loop iteration, so an idle board costs no lock.
+        if (board_mirror && board_mirror->is_behind(store))
+        {
+            auto lock = store.lock();
+            board_mirror->publish(store);
+        }
+    }
+
+    auto server::queue_raw_for_send(
+        client_connection &client,
+        std::string        data_to_send
+    ) -> void
+    {
+        OREORE_PROBE2(queue, client.get_fd(), data_to_send.size());
+        buffered_bytes += data_to_send.size();
+        client.get_write_buffer().append(std::move(data_to_send));
+
+        if (!client.is_writing_registered() && !client.get_write_buffer().empty())
+        {
+            trace_span send_span(connection_trace(client), "send", client.get_fd());
+            ssize_t    sent_bytes = send(
+                client.get_fd(),
+                client.get_write_buffer().data(),
+                client.get_write_buffer().length(),
+                MSG_NOSIGNAL
+            );
+            send_span.end();
+            if (sent_bytes >= 0)
+            {
+                OREORE_PROBE2(flush, client.get_fd(), sent_bytes);
+                client.get_write_buffer().erase(0, sent_bytes);
+                buffered_bytes -= static_cast<size_t>(sent_bytes);
+            }
+            else
+            { // sent_bytes == -1
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    close_client(
+                        client.get_fd(),
+                        make_errno_message("send error").c_str()
+                    );
+                    return;
+                }
+            }
+        }
+
+        if (!client.get_write_buffer().empty() && !client.is_writing_registered())
+        {
+            auto mod_result
+                = modify_descriptor(client.get_fd(), EPOLLIN | EPOLLOUT | EPOLLET);
+            if (!mod_result.has_value())
+            {
+                close_client(client.get_fd(), "epoll_modify for EPOLLOUT failed");
+                return;
+            }
+            client.is_writing_registered() = true;
+        }
+    }
+
+    auto server::handle_client_read(client_connection &client) -> void
+    {
+        // A connection waiting for its output to drain leaves input in the
+        // socket, so the peer's sends back up too. The write side reads it
+        // once the wait is over.
+        if (client.get_flush_waiter())
+        {
+            return;
+        }
+
+        char buffer[BUFFER_SIZE];
+        bool client_alive = true;
+        // Sampled once here, so a traced request shows every phase from
+        // recv to send.
+        client.set_traced(tracer && tracer->sample());
+        trace_span read_span(connection_trace(client), "recv", client.get_fd());
+
+        while (true)
+        {
+            ssize_t bytes_received
+                = recv(client.get_fd(), buffer, sizeof(buffer), 0);
+            if (bytes_received > 0)
+            {
+                OREORE_PROBE2(read, client.get_fd(), bytes_received);
+                client.get_read_buffer().append(buffer, bytes_received);
+                buffered_bytes += static_cast<size_t>(bytes_received);
+            }
+            else if (bytes_received == 0)
+            {
+                close_client(client.get_fd(), "client disconnected");
+                client_alive = false;
+                break;
+            }
+            else
+            { // bytes_received == -1
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                close_client(
+                    client.get_fd(),
+                    make_errno_message("recv error").c_str()
+                );
+                client_alive = false;
+                break;
+            }
+        }
+
+        read_span.end();
+        if (!client_alive)
+            return;
+
+        if (options.latency == latency_profile::low_latency
+            && !client.is_local_peer())
+        {
+            rearm_quick_ack(client.get_fd());
+        }
+        if (auto waiter = std::exchange(client.get_input_waiter(), nullptr))
+        {
+            resume_connection(client, waiter);
+        }
+    }
+
+    auto server::handle_client_write(client_connection &client) -> void
+    {
+        int client_fd = client.get_fd();
+
+        if (client.get_write_buffer().empty())
+        {
+            if (client.is_writing_registered())
+            {
+                modify_descriptor(client.get_fd(), EPOLLIN | EPOLLET);
+                client.is_writing_registered() = false;
+            }
+            return;
+        }
+
+        trace_span send_span(connection_trace(client), "send", client_fd);
+        ssize_t    bytes_sent = send(
+            client.get_fd(),
+            client.get_write_buffer().data(),
+            client.get_write_buffer().length(),
+            MSG_NOSIGNAL
+        );
+        send_span.end();
+
+        if (bytes_sent >= 0)
+        {
+            OREORE_PROBE2(flush, client_fd, bytes_sent);
+            client.get_write_buffer().erase(0, bytes_sent);
+            buffered_bytes -= static_cast<size_t>(bytes_sent);
+            if (client.get_write_buffer().empty())
+            {
+                if (draining)
+                {
+                    close_client(client_fd, "drained for hot restart");
+                    return;
+                }
+                // Refill a drained replica stream before dropping EPOLLOUT.
+                pump_replica(client);
+            }
+            if (client_connections.contains(client_fd)
+                && client.get_write_buffer().empty()
+                && client.is_writing_registered())
+            {
+                modify_descriptor(client.get_fd(), EPOLLIN | EPOLLET);
+                client.is_writing_registered() = false;
+            }
+            if (client_connections.contains(client_fd)
+                && client.get_write_buffer().empty())
+            {
+                if (auto waiter = std::exchange(client.get_flush_waiter(), nullptr))
+                {
+                    resume_connection(client, waiter);
+                    // Edge-triggered: input that arrived during the wait
+                    // will not be signalled again.
+                    if (client_connections.contains(client_fd))
+                    {
+                        handle_client_read(client);
+                    }
+                }
+            }
+        }
+        else
+        { // bytes_sent == -1
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                close_client(
+                    client.get_fd(),
+                    make_errno_message("send error").c_str()
+                );
             }
-            return fd;
-        }(std::move(server_socket_fd));
+        }
+    }
 
-        if (!configure_res)
+    auto server::make(const server_options &server_config)
+        -> std::expected<server, std::string>
+    {
+        buffer_pool::set_huge_pages(server_config.huge_pages);
+
+        if ((server_config.shard_index || !server_config.shard_addresses.empty())
+            && server_config.cluster_secret.empty())
         {
-            return std::unexpected(configure_res.error());
+            return std::unexpected("Routers and shard nodes need a --cluster-secret.");
         }
-        server_socket_fd = std::move(configure_res.value());
 
-        // Step 3: Bind and Listen
-        auto bind_listen_res = [&](scoped_file_descriptor fd)
-            -> std::expected<scoped_file_descriptor, std::string>
+        if (!server_config.shard_addresses.empty())
         {
-            sockaddr_in server_address {};
-            server_address.sin_family      = AF_INET;
-            server_address.sin_addr.s_addr = INADDR_ANY;
-            server_address.sin_port        = htons(port);
-            if (bind(fd.get(), (struct sockaddr *)&server_address, sizeof(server_address))
-                < 0)
+            if (server_config.primary_address || server_config.shard_index)
             {
-                return std::unexpected(make_errno_message("bind() failed"));
+                return std::unexpected(
+                    "A router can be neither a follower nor a shard node."
+                );
             }
-            if (listen(fd.get(), backlog) < 0)
+            if (server_config.shard_addresses.size() > MAX_SHARDS)
             {
-                return std::unexpected(make_errno_message("listen() failed"));
+                return std::unexpected(
+                    "A cluster has at most " + std::to_string(MAX_SHARDS) + " shards."
+                );
             }
-            return fd;
-        }(std::move(server_socket_fd));
+        }
 
-        if (!bind_listen_res)
+        // Step 1: Obtain the listening sockets, either fresh or from the
+        // process we are replacing
+        std::vector<scoped_file_descriptor> listeners;
+        std::optional<handoff_state>        handoff;
+        if (server_config.takeover_socket_path)
         {
-            return std::unexpected(bind_listen_res.error());
+            auto handoff_expected = receive_handoff(
+                *server_config.takeover_socket_path,
+                server_config.takeover_clients
+            );
+            if (!handoff_expected)
+            {
+                return std::unexpected(handoff_expected.error());
+            }
+            handoff   = std::move(handoff_expected.value());
+            listeners = std::move(handoff->listeners);
+        }
+        else
+        {
+            for (const listen_endpoint &endpoint : server_config.listen_endpoints)
+            {
+                auto listener_expected = make_listening_socket(
+                    endpoint,
+                    server_config.backlog,
+                    server_config.distribution == listener_distribution::reuseport,
+                    server_config.latency
+                );
+                if (!listener_expected)
+                {
+                    return std::unexpected(listener_expected.error());
+                }
+                listeners.push_back(std::move(listener_expected.value()));
+            }
+        }
+        if (listeners.empty())
+        {
+            return std::unexpected("No endpoints to listen on.");
         }
-        server_socket_fd = std::move(bind_listen_res.value());
 
-        // Step 4: Create Epoll
+        // Step 2: Create Epoll
         std::expected<scoped_file_descriptor, std::string> epoll_fd_expected =
             []() -> std::expected<scoped_file_descriptor, std::string>
         {
@@ -549,19 +1734,227 @@ namespace oreore
         }
         scoped_file_descriptor epoll_fd = std::move(epoll_fd_expected.value());
 
-        // Step 5: Construct server and register listening socket
-        server new_server(std::move(epoll_fd), std::move(server_socket_fd));
-        auto   register_res = new_server.register_descriptor(
-            new_server.server_file_descriptor.get(),
-            EPOLLIN | EPOLLET
-        );
-        if (!register_res)
+        // Step 3: Construct server and register listening sockets
+        server new_server(std::move(epoll_fd), std::move(listeners), server_config);
+        for (const scoped_file_descriptor &listener : new_server.listener_fds)
+        {
+            auto register_res = new_server.register_descriptor(
+                listener.get(),
+                new_server.listener_events()
+            );
+            if (!register_res)
+            {
+                return std::unexpected(register_res.error());
+            }
+        }
+
+        // Step 4: Follower mode needs a link to the primary and a retry timer
+        if (server_config.primary_address)
+        {
+            auto link_expected
+                = replication_link::make(*server_config.primary_address);
+            if (!link_expected)
+            {
+                return std::unexpected(link_expected.error());
+            }
+            new_server.primary_link = std::move(link_expected.value());
+
+            new_server.replication_timer_fd = scoped_file_descriptor(
+                timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)
+            );
+            if (new_server.replication_timer_fd.get() == -1)
+            {
+                return std::unexpected(make_errno_message("timerfd_create failed")
+                );
+            }
+            auto timer_register_res = new_server.register_descriptor(
+                new_server.replication_timer_fd.get(),
+                EPOLLIN
+            );
+            if (!timer_register_res)
+            {
+                return std::unexpected(timer_register_res.error());
+            }
+        }
+
+        // Step 5: A router connects to its shard nodes
+        if (!server_config.shard_addresses.empty())
+        {
+            for (const std::string &address : server_config.shard_addresses)
+            {
+                auto link_expected
+                    = shard_link::make(address, server_config.cluster_secret);
+                if (!link_expected)
+                {
+                    return std::unexpected(link_expected.error());
+                }
+                new_server.shard_links.push_back(std::move(link_expected.value()));
+            }
+            new_server.placement.emplace(new_server.shard_links.size());
+            // A node that is not up yet is retried on first use.
+            for (size_t shard = 0; shard < new_server.shard_links.size(); ++shard)
+            {
+                if (auto connect_res = new_server.connect_shard(shard); !connect_res)
+                {
+                    std::cerr << connect_res.error() << std::endl;
+                }
+            }
+        }
+
+        // Step 6: Start the render workers for large GETs
+        if (server_config.render_workers > 0)
+        {
+            auto pool_expected = render_pool::make(server_config.render_workers);
+            if (!pool_expected)
+            {
+                return std::unexpected(pool_expected.error());
+            }
+            new_server.renderer = std::move(pool_expected.value());
+            auto render_register_res = new_server.register_descriptor(
+                new_server.renderer->get_completion_fd(),
+                EPOLLIN
+            );
+            if (!render_register_res)
+            {
+                return std::unexpected(render_register_res.error());
+            }
+        }
+
+        // Step 7: Open the trace file for sampled request spans and the
+        // traffic recording
+        if (server_config.trace_path)
+        {
+            auto tracer_expected = trace_recorder::make(
+                *server_config.trace_path,
+                server_config.trace_sample_every
+            );
+            if (!tracer_expected)
+            {
+                return std::unexpected(tracer_expected.error());
+            }
+            new_server.tracer = std::move(tracer_expected.value());
+        }
+        if (server_config.record_path)
+        {
+            auto recorder_expected = traffic_recorder::make(*server_config.record_path);
+            if (!recorder_expected)
+            {
+                return std::unexpected(recorder_expected.error());
+            }
+            new_server.recorder = std::move(recorder_expected.value());
+        }
+
+        // Step 8: Publish the board in shared memory for local readers
+        if (server_config.shared_board_name)
+        {
+            auto board_expected = shared_board::make(
+                *server_config.shared_board_name,
+                server_config.shared_board_capacity
+            );
+            if (!board_expected)
+            {
+                return std::unexpected(board_expected.error());
+            }
+            new_server.board_mirror = std::move(board_expected.value());
+        }
+
+        // Step 9: Adopt the board and connections of the previous process
+        scoped_file_descriptor takeover_peer;
+        if (handoff)
+        {
+            takeover_peer  = std::move(handoff->peer);
+            auto adopt_res = new_server.adopt_handoff(std::move(*handoff));
+            if (!adopt_res)
+            {
+                return std::unexpected(adopt_res.error());
+            }
+        }
+        if (new_server.board_mirror)
+        {
+            new_server.publish_shared_board();
+        }
+
+        // Step 10: Accept hot-restart requests from a future replacement.
+        // While taking over, bind under a private name: the previous
+        // process's socket must stay reachable until it lets go.
+        std::optional<std::string> staged_handoff_path;
+        if (server_config.handoff_socket_path)
+        {
+            std::string handoff_path = *server_config.handoff_socket_path;
+            if (handoff)
+            {
+                handoff_path += "." + std::to_string(getpid());
+                staged_handoff_path = handoff_path;
+            }
+            auto handoff_listener_expected = make_handoff_listener(handoff_path);
+            if (!handoff_listener_expected)
+            {
+                return std::unexpected(handoff_listener_expected.error());
+            }
+            new_server.handoff_listener_fd
+                = std::move(handoff_listener_expected.value());
+            auto handoff_register_res = new_server.register_descriptor(
+                new_server.handoff_listener_fd.get(),
+                EPOLLIN
+            );
+            if (!handoff_register_res)
+            {
+                return std::unexpected(handoff_register_res.error());
+            }
+        }
+
+        // Step 11: Everything is in place, so tell the previous process to
+        // drain; until then it keeps serving and a failure above loses
+        // nothing. Then take over the names readers and replacements use.
+        if (handoff)
+        {
+            if (auto confirm_res = confirm_takeover(takeover_peer.get()); !confirm_res)
+            {
+                if (staged_handoff_path)
+                {
+                    ::unlink(staged_handoff_path->c_str());
+                }
+                return std::unexpected(confirm_res.error());
+            }
+        }
+        // Only a fully populated shared board replaces the published one.
+        if (new_server.board_mirror)
+        {
+            auto live_res = new_server.board_mirror->go_live();
+            if (!live_res && !handoff)
+            {
+                return std::unexpected(live_res.error());
+            }
+            if (!live_res)
+            {
+                std::cerr << live_res.error() << std::endl;
+            }
+        }
+        if (staged_handoff_path
+            && ::rename(
+                   staged_handoff_path->c_str(),
+                   server_config.handoff_socket_path->c_str()
+               ) == -1)
         {
-            return std::unexpected(register_res.error());
+            std::cerr << make_errno_message("hot restart: rename(" + *staged_handoff_path
+                                            + ") failed")
+                      << std::endl;
         }
 
-        std::cout << "Server configured successfully on port " << port << "."
-                  << std::endl;
+        std::cout << "Server configured successfully on";
+        if (handoff)
+        {
+            std::cout << " " << new_server.listener_fds.size()
+                      << " inherited listener(s)";
+        }
+        else
+        {
+            for (const listen_endpoint &endpoint : server_config.listen_endpoints)
+            {
+                std::cout << " " << describe_listen_endpoint(endpoint);
+            }
+        }
+        std::cout << "." << std::endl;
         return new_server; // Implicit move
     }
 
@@ -569,13 +1962,67 @@ namespace oreore
     {
         std::vector<epoll_event> events_vector(MAX_EPOLL_EVENTS);
 
-        while (true)
+        if (is_follower())
+        {
+            start_replication();
+        }
+        // Connections adopted from a previous process get their coroutines
+        // now that the server has stopped moving. Starting one can close it,
+        // so walk a copy of the descriptors.
+        std::vector<int> adopted_fds;
+        for (auto &[client_fd, client] : client_connections)
+        {
+            if (!client.get_task().valid())
+            {
+                adopted_fds.push_back(client_fd);
+            }
+        }
+        for (int client_fd : adopted_fds)
         {
-            int num_events = epoll_wait(
+            if (auto client_iterator = client_connections.find(client_fd);
+                client_iterator != client_connections.end())
+            {
+                start_connection(client_iterator->second);
+            }
+        }
+
+        // While recent events keep arriving, poll without sleeping so the
+        // next request skips the wakeup latency.
+        auto spin_deadline = std::chrono::steady_clock::time_point::min();
+
+        while (!draining || !drain_finished())
+        {
+            bool spinning = options.busy_spin.count() > 0
+                         && std::chrono::steady_clock::now() < spin_deadline;
+            // An overloaded loop keeps waking up so an idle period can
+            // bring it back to normal.
+            int timeout = spinning                                      ? 0
+                        : draining || takeover                          ? DRAIN_POLL_INTERVAL_MS
+                        : overload.get_level() != overload_level::normal ? OVERLOAD_RECHECK_MS
+                                                                        : -1;
+            resume_ready_shard_calls();
+            if (takeover)
+            {
+                advance_takeover();
+            }
+            publish_shared_board();
+            if (timeout != 0)
+            {
+                // Idle time is free time for the trace and record writes.
+                if (tracer)
+                {
+                    tracer->flush();
+                }
+                if (recorder)
+                {
+                    recorder->flush();
+                }
+            }
+            int  num_events = epoll_wait(
                 epoll_file_descriptor.get(),
                 events_vector.data(),
                 MAX_EPOLL_EVENTS,
-                -1
+                timeout
             );
 
             if (num_events == -1)
@@ -585,24 +2032,62 @@ namespace oreore
                 perror("epoll_wait error");
                 break;
             }
+            if (timeout == 0 && num_events == 0)
+            {
+                ++loop_stats.busy_polls;
+                continue;
+            }
+            if (timeout != 0)
+            {
+                ++loop_stats.blocking_waits;
+            }
+            auto batch_start = std::chrono::steady_clock::now();
+            if (num_events > 0 && options.busy_spin.count() > 0)
+            {
+                spin_deadline = batch_start + options.busy_spin;
+            }
 
             for (int i = 0; i < num_events; ++i)
             {
                 int      current_fd       = events_vector[i].data.fd;
                 uint32_t triggered_events = events_vector[i].events;
 
-                if (current_fd == server_file_descriptor.get())
+                if (is_listener(current_fd))
                 {
                     if (triggered_events & EPOLLIN)
                     {
-                        accept_new_connections();
+                        accept_new_connections(current_fd);
                     }
                 }
+                else if (renderer && current_fd == renderer->get_completion_fd())
+                {
+                    handle_render_completions();
+                }
+                else if (current_fd == handoff_listener_fd.get())
+                {
+                    handle_handoff_request();
+                }
+                else if (takeover && current_fd == takeover->get_fd())
+                {
+                    handle_takeover_event(triggered_events);
+                }
+                else if (is_follower() && current_fd == replication_timer_fd.get())
+                {
+                    handle_replication_timer();
+                }
+                else if (is_follower() && current_fd == primary_link->get_fd())
+                {
+                    handle_replication_link(triggered_events);
+                }
                 else
                 {
                     auto client_iterator = client_connections.find(current_fd);
                     if (client_iterator == client_connections.end())
+                    {
+                        // The only other descriptors are a router's links.
+                        handle_shard_event(current_fd, triggered_events);
                         continue;
+                    }
 
                     client_connection &client = client_iterator->second;
 
@@ -613,21 +2098,126 @@ namespace oreore
                     }
                     else
                     {
-                        if (triggered_events & EPOLLIN)
+                        // A draining server no longer owns the board, so it
+                        // only flushes what is already queued.
+                        if ((triggered_events & EPOLLIN) && !draining
+                            && !is_handing_off())
                         {
                             handle_client_read(client);
                         }
                         // Check if client still exists after read before
                         // attempting write
                         if (client_connections.count(current_fd)
-                            && (triggered_events & EPOLLOUT))
+                            && (triggered_events & EPOLLOUT)
+                            && !is_handing_off_clients())
                         {
                             handle_client_write(client);
                         }
                     }
                 }
             }
+
+            update_overload(std::chrono::steady_clock::now() - batch_start);
+        }
+    }
+
+    auto make_listening_socket(
+        uint16_t        port,
+        int             backlog,
+        bool            reuse_port,
+        latency_profile profile
+    ) -> std::expected<scoped_file_descriptor, std::string>
+    {
+        // Step 1: Setup socket
+        std::expected<scoped_file_descriptor, std::string> server_socket_fd_expected
+            = [&]() -> std::expected<scoped_file_descriptor, std::string>
+        {
+            scoped_file_descriptor fd(socket(AF_INET, SOCK_STREAM, 0));
+            if (fd.get() == -1)
+                return std::unexpected(make_errno_message("socket() failed"));
+            return fd;
+        }();
+        if (!server_socket_fd_expected)
+        {
+            return std::unexpected(server_socket_fd_expected.error());
+        }
+        scoped_file_descriptor server_socket_fd
+            = std::move(server_socket_fd_expected.value());
+
+        // Step 2: Configure socket
+        auto configure_res = [&](scoped_file_descriptor fd)
+            -> std::expected<scoped_file_descriptor, std::string>
+        {
+            int option_value = 1;
+            if (setsockopt(
+                    fd.get(),
+                    SOL_SOCKET,
+                    SO_REUSEADDR,
+                    &option_value,
+                    sizeof(option_value)
+                )
+                == -1)
+            {
+                return std::unexpected(make_errno_message("setsockopt(SO_"
+                                                          "REUSEADDR) failed"));
+            }
+            if (reuse_port
+                && setsockopt(
+                       fd.get(),
+                       SOL_SOCKET,
+                       SO_REUSEPORT,
+                       &option_value,
+                       sizeof(option_value)
+                   )
+                       == -1)
+            {
+                return std::unexpected(make_errno_message("setsockopt(SO_"
+                                                          "REUSEPORT) failed"));
+            }
+            if (auto result = make_socket_non_blocking(fd.get()); !result)
+            { // Check has_value() implicitly
+                return std::unexpected(result.error());
+            }
+            // Buffer sizes must be in place before listen(): the window
+            // scale offered in the SYN-ACK is fixed by the receive buffer.
+            if (auto result = tune_listener(fd.get(), profile); !result)
+            {
+                return std::unexpected(result.error());
+            }
+            return fd;
+        }(std::move(server_socket_fd));
+
+        if (!configure_res)
+        {
+            return std::unexpected(configure_res.error());
+        }
+        server_socket_fd = std::move(configure_res.value());
+
+        // Step 3: Bind and Listen
+        auto bind_listen_res = [&](scoped_file_descriptor fd)
+            -> std::expected<scoped_file_descriptor, std::string>
+        {
+            sockaddr_in server_address {};
+            server_address.sin_family      = AF_INET;
+            server_address.sin_addr.s_addr = INADDR_ANY;
+            server_address.sin_port        = htons(port);
+            if (bind(fd.get(), (struct sockaddr *)&server_address, sizeof(server_address))
+                < 0)
+            {
+                return std::unexpected(make_errno_message("bind() failed"));
+            }
+            if (listen(fd.get(), backlog) < 0)
+            {
+                return std::unexpected(make_errno_message("listen() failed"));
+            }
+            return fd;
+        }(std::move(server_socket_fd));
+
+        if (!bind_listen_res)
+        {
+            return std::unexpected(bind_listen_res.error());
         }
+        return std::move(bind_listen_res.value());
     }
 
     auto make_socket_non_blocking(int socket_fd)
@@ -0,0 +1,500 @@
+#include <oreore/server.hpp>
+
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <sys/epoll.h>
+#include <utility>
+
+namespace oreore
+{
+    namespace
+    {
+        auto shard_waiter_key(size_t shard, uint32_t request_id) -> uint64_t
+        {
+            return (static_cast<uint64_t>(shard) << 32) | request_id;
+        }
+
+        auto shard_unavailable(size_t shard) -> std::string
+        {
+            return "ERR: Shard " + std::to_string(shard) + " is unavailable.\n";
+        }
+    }
+
+    // Parks the awaiting connection until every shard it asked has
+    // answered; a shard that is down answers with an error. The last reply
+    // queues the call for the loop to resume, since it may arrive while
+    // another connection's coroutine is running (a failed send in that
+    // connection's call fails the shard for everyone). If the connection is
+    // closed first, destroying its frame unregisters the call and late
+    // replies are dropped.
+    struct server::shard_call
+    {
+        server                  &owner;
+        client_connection       &client;
+        std::vector<std::string> replies;
+        std::vector<uint64_t>    keys;
+        size_t                   outstanding;
+        std::coroutine_handle<>  waiter;
+
+        shard_call(
+            server                      &target,
+            client_connection           &requester,
+            std::span<const size_t>      shards,
+            std::span<const std::string> payloads
+        )
+            : owner(target)
+            , client(requester)
+            , replies(shards.size())
+            , outstanding(0)
+        {
+            for (size_t slot = 0; slot < shards.size(); ++slot)
+            {
+                size_t           shard   = shards[slot];
+                std::string_view payload = payloads[slot];
+                if (payload.size() > MAX_BINARY_PAYLOAD_SIZE)
+                {
+                    replies[slot] = "ERR: Command too large to route.\n";
+                    continue;
+                }
+                if (auto connect_res = owner.connect_shard(shard); !connect_res)
+                {
+                    std::cerr << connect_res.error() << std::endl;
+                    replies[slot] = shard_unavailable(shard);
+                    continue;
+                }
+                shard_link &link = owner.shard_links[shard];
+                uint64_t    key  = shard_waiter_key(shard, link.queue_request(payload));
+                owner.shard_waiters.emplace(key, std::pair { this, slot });
+                keys.push_back(key);
+                ++outstanding;
+
+                if (auto send_res = link.send_pending(); !send_res)
+                {
+                    owner.fail_shard(shard, send_res.error());
+                }
+            }
+        }
+
+        shard_call(const shard_call &)                     = delete;
+        auto operator=(const shard_call &) -> shard_call & = delete;
+
+        ~shard_call(void)
+        {
+            for (uint64_t key : keys)
+            {
+                auto waiter_iterator = owner.shard_waiters.find(key);
+                if (waiter_iterator != owner.shard_waiters.end()
+                    && waiter_iterator->second.first == this)
+                {
+                    owner.shard_waiters.erase(waiter_iterator);
+                }
+            }
+            std::erase(owner.ready_shard_calls, this);
+        }
+
+        auto await_ready(void) const noexcept -> bool
+        {
+            return outstanding == 0;
+        }
+
+        auto await_suspend(std::coroutine_handle<> suspended) noexcept -> void
+        {
+            waiter = suspended;
+        }
+
+        auto await_resume(void) -> std::vector<std::string>
+        {
+            return std::move(replies);
+        }
+    };
+
+    auto server::is_router(void) const -> bool
+    {
+        return !shard_links.empty();
+    }
+
+    auto server::connect_shard(size_t shard) -> std::expected<void, std::string>
+    {
+        shard_link &link = shard_links[shard];
+        if (link.get_fd() != -1)
+        {
+            return {};
+        }
+
+        if (auto connect_res = link.start_connect(); !connect_res)
+        {
+            return std::unexpected(connect_res.error());
+        }
+        if (auto register_res
+            = register_descriptor(link.get_fd(), EPOLLIN | EPOLLOUT | EPOLLET);
+            !register_res)
+        {
+            link.disconnect();
+            return std::unexpected(register_res.error());
+        }
+        std::cout << "Connecting to shard " << shard << " at "
+                  << link.get_address() << std::endl;
+        return {};
+    }
+
+    auto server::fail_shard(size_t shard, const std::string &reason) -> void
+    {
+        shard_link &link = shard_links[shard];
+        std::cerr << "Shard " << shard << " (" << link.get_address()
+                  << ") down: " << reason << std::endl;
+        if (link.get_fd() != -1)
+        {
+            unregister_descriptor(link.get_fd());
+        }
+        link.disconnect();
+
+        // Whoever was waiting on this shard gets an error instead. The next
+        // request reconnects.
+        std::vector<uint64_t> failed;
+        for (const auto &[key, waiter] : shard_waiters)
+        {
+            if (key >> 32 == shard)
+            {
+                failed.push_back(key);
+            }
+        }
+        for (uint64_t key : failed)
+        {
+            deliver_shard_reply(key, shard_unavailable(shard));
+        }
+    }
+
+    auto server::handle_shard_event(int fd, uint32_t events) -> void
+    {
+        size_t shard = 0;
+        while (shard < shard_links.size() && shard_links[shard].get_fd() != fd)
+        {
+            ++shard;
+        }
+        if (shard == shard_links.size())
+        {
+            return;
+        }
+        shard_link &link = shard_links[shard];
+
+        if (!link.is_connected())
+        {
+            if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+            {
+                return;
+            }
+            if (auto finish_res = link.finish_connect(); !finish_res)
+            {
+                fail_shard(shard, finish_res.error());
+                return;
+            }
+            std::cout << "Connected to shard " << shard << " at "
+                      << link.get_address() << std::endl;
+        }
+        else if (events & EPOLLOUT)
+        {
+            if (auto send_res = link.send_pending(); !send_res)
+            {
+                fail_shard(shard, send_res.error());
+                return;
+            }
+        }
+
+        if (!(events & (EPOLLIN | EPOLLERR | EPOLLHUP)))
+        {
+            return;
+        }
+        // Hand out whatever arrived before reporting a closed connection.
+        auto receive_res = link.receive();
+        while (link.get_fd() == fd)
+        {
+            auto reply = link.take_reply();
+            if (!reply)
+            {
+                fail_shard(shard, reply.error());
+                return;
+            }
+            if (!*reply)
+            {
+                break;
+            }
+            deliver_shard_reply(
+                shard_waiter_key(shard, (*reply)->request_id),
+                std::move((*reply)->text)
+            );
+        }
+        if (!receive_res && link.get_fd() == fd)
+        {
+            fail_shard(shard, receive_res.error());
+        }
+    }
+
+    auto server::deliver_shard_reply(uint64_t key, std::string text) -> void
+    {
+        auto waiter_iterator = shard_waiters.find(key);
+        if (waiter_iterator == shard_waiters.end())
+        {
+            return;
+        }
+        auto [call, slot] = waiter_iterator->second;
+        shard_waiters.erase(waiter_iterator);
+
+        call->replies[slot] = std::move(text);
+        if (--call->outstanding == 0 && call->waiter)
+        {
+            ready_shard_calls.push_back(call);
+        }
+    }
+
+    auto server::resume_ready_shard_calls(void) -> void
+    {
+        // A resumed connection may queue more calls, or close one still
+        // queued, so take them one at a time.
+        while (!ready_shard_calls.empty())
+        {
+            shard_call *call = ready_shard_calls.front();
+            ready_shard_calls.pop_front();
+            resume_connection(call->client, std::exchange(call->waiter, nullptr));
+        }
+    }
+
+    auto server::call_shards(
+        client_connection           &client,
+        std::span<const size_t>      shards,
+        std::span<const std::string> payloads
+    ) -> shard_call
+    {
+        return shard_call(*this, client, shards, payloads);
+    }
+
+    auto server::forward_to_shard(
+        client_connection &client,
+        size_t             shard,
+        std::string        command
+    ) -> task<std::string>
+    {
+        std::string payload = encode_routed_command(client.get_peer_string(), command);
+        std::vector<std::string> replies = co_await call_shards(
+            client,
+            std::span<const size_t>(&shard, 1),
+            std::span<const std::string>(&payload, 1)
+        );
+        co_return std::move(replies.front());
+    }
+
+    auto server::route_command(
+        client_connection &client,
+        const std::string &command_token,
+        const std::string &command_line
+    ) -> task<std::string>
+    {
+        std::istringstream arguments(command_line);
+        std::string        skipped_token;
+        arguments >> skipped_token;
+
+        if (command_token == "POST")
+        {
+            co_return co_await forward_to_shard(
+                client,
+                placement->owner(client.get_peer_string()),
+                command_line
+            );
+        }
+        if (command_token == "HAPPY" || command_token == "SAD")
+        {
+            // The ID names its shard. The shard also reports malformed IDs,
+            // so those go to shard 0 and get the usual error.
+            std::string id_str;
+            arguments >> id_str;
+            auto   message_id = parse_unsigned(id_str);
+            size_t shard      = message_id ? shard_of(*message_id) : 0;
+            if (shard >= shard_links.size())
+            {
+                co_return "ERR: Message ID " + id_str + " not found.\n";
+            }
+            co_return co_await forward_to_shard(client, shard, command_line);
+        }
+
+        std::vector<size_t> every_shard(shard_links.size());
+        std::iota(every_shard.begin(), every_shard.end(), size_t { 0 });
+        if (command_token == "GET")
+        {
+            auto filter = parse_get_filter(arguments);
+            if (!filter)
+            {
+                co_return filter.error();
+            }
+            // Shards answer a page at a time, and only the shards whose page
+            // ran dry are asked for more, so the router never buffers more
+            // than a page per shard besides the result.
+            shard_merge         merge(shard_links.size());
+            message_filter      page_filter = *filter;
+            std::vector<size_t> wanted      = every_shard;
+            std::string         rendered;
+            bool                first_round = true;
+            while (!wanted.empty())
+            {
+                page_filter.limit
+                    = std::min(SHARD_PAGE_MESSAGES, filter->limit - merge.matches());
+                std::vector<std::string> payloads;
+                payloads.reserve(wanted.size());
+                for (size_t shard : wanted)
+                {
+                    page_filter.after_id = merge.resume_after(shard).or_else(
+                        [&filter] { return filter->after_id; }
+                    );
+                    payloads.push_back(encode_routed_command(
+                        client.get_peer_string(),
+                        format_shard_get(page_filter)
+                    ));
+                }
+                std::vector<std::string> replies
+                    = co_await call_shards(client, wanted, payloads);
+                for (size_t slot = 0; slot < wanted.size(); ++slot)
+                {
+                    auto add_res = merge.add_page(
+                        wanted[slot],
+                        std::move(replies[slot]),
+                        page_filter.limit
+                    );
+                    if (!add_res)
+                    {
+                        co_return add_res.error();
+                    }
+                }
+
+                // The cluster's version is the sum of the shards' versions,
+                // so it moves whenever any shard's board does. It is taken
+                // from the first pages, like a single-node GET's snapshot.
+                if (std::exchange(first_round, false) && filter->if_changed_since
+                    && *filter->if_changed_since == merge.version())
+                {
+                    co_return "NOT MODIFIED: " + std::to_string(merge.version()) + "\n";
+                }
+                wanted = merge.drain(rendered, filter->limit);
+            }
+
+            if (merge.matches() == 0)
+            {
+                rendered = merge.boards_empty() ? EMPTY_BOARD_REPLY : NO_MATCH_REPLY;
+            }
+            if (filter->if_changed_since)
+            {
+                rendered += "VERSION: " + std::to_string(merge.version()) + "\n";
+            }
+            co_return rendered;
+        }
+        if (command_token == "SEARCH")
+        {
+            // Each shard validates the arguments; only the limit matters here.
+            std::string term;
+            std::string limit_str;
+            arguments >> term >> limit_str;
+            size_t limit = parse_unsigned(limit_str).value_or(DEFAULT_SEARCH_LIMIT);
+
+            std::vector<std::string> payloads(
+                every_shard.size(),
+                encode_routed_command(client.get_peer_string(), command_line)
+            );
+            std::vector<std::string> replies
+                = co_await call_shards(client, every_shard, payloads);
+            shard_merge merge(shard_links.size());
+            for (size_t shard = 0; shard < replies.size(); ++shard)
+            {
+                auto add_res = merge.add_page(shard, std::move(replies[shard]), SIZE_MAX);
+                if (!add_res)
+                {
+                    co_return add_res.error();
+                }
+            }
+            std::string rendered;
+            merge.drain(rendered, limit);
+            co_return merge.matches() == 0 ? std::string(NO_MATCH_REPLY)
+                                           : std::move(rendered);
+        }
+        if (command_token == "BATCH" || command_token == REPLICATE_COMMAND
+            || command_token == BINARY_HANDSHAKE_LINE)
+        {
+            co_return "ERR: " + command_token + " is not available on a router.\n";
+        }
+
+        co_return "ERR: Unknown command '" + command_token + "'.\n";
+    }
+
+    auto server::route_batch(client_connection &client, std::span<const std::string> texts)
+        -> task<std::string>
+    {
+        std::string command = "MPOST";
+        for (const std::string &text : texts)
+        {
+            command.append("\n").append(text);
+        }
+        co_return co_await forward_to_shard(
+            client,
+            placement->owner(client.get_peer_string()),
+            std::move(command)
+        );
+    }
+
+    auto server::run_routed_command(
+        client_connection &client,
+        const std::string &sender_ip,
+        std::string_view   command
+    ) -> task<std::string>
+    {
+        if (command.starts_with("MPOST\n"))
+        {
+            if (is_follower())
+            {
+                co_return read_only_error();
+            }
+            // The router forwards the client's lines untouched, empty ones
+            // included, so they are normalized here exactly once.
+            std::vector<std::string> texts;
+            command.remove_prefix(6);
+            for (;;)
+            {
+                size_t newline_pos = command.find('\n');
+                texts.emplace_back(command.substr(0, newline_pos));
+                if (newline_pos == std::string_view::npos
+                    || texts.size() > MAX_BATCH_SIZE)
+                {
+                    break;
+                }
+                command.remove_prefix(newline_pos + 1);
+            }
+            if (texts.size() > MAX_BATCH_SIZE)
+            {
+                co_return "ERR: Malformed or oversized batch payload.\n";
+            }
+            auto normalized = normalize_batch(texts);
+            if (!normalized)
+            {
+                co_return normalized.error();
+            }
+            auto      lock     = store.lock();
+            uintmax_t first_id = store.post_batch(*normalized, sender_ip);
+            co_return posted_range_reply(first_id, normalized->size());
+        }
+
+        std::string        command_line(command);
+        std::istringstream arguments(command_line);
+        std::string        command_token;
+        arguments >> command_token;
+        if (command_token == "GET")
+        {
+            // Large results still render on the workers.
+            auto filter = parse_get_filter(arguments);
+            if (!filter)
+            {
+                co_return filter.error();
+            }
+            co_return co_await serve_get(client, *filter);
+        }
+
+        auto lock = store.lock();
+        co_return execute_store_command(sender_ip, command_line);
+    }
+
+}
@@ -0,0 +1,214 @@
+#include <oreore/server.hpp>
+
+#include <utility>
+
+namespace oreore
+{
+    // Parks the awaiting connection until a worker finishes the render. If
+    // the connection is closed first, destroying its frame unregisters the
+    // awaiter and the result is dropped.
+    struct server::render_awaiter
+    {
+        server                 &owner;
+        client_connection      &client;
+        render_job              job;
+        std::string             rendered;
+        std::coroutine_handle<> waiter;
+
+        render_awaiter(server &target, client_connection &requester, render_job &&pending)
+            : owner(target)
+            , client(requester)
+            , job(std::move(pending))
+        {
+        }
+
+        render_awaiter(const render_awaiter &)                     = delete;
+        auto operator=(const render_awaiter &) -> render_awaiter & = delete;
+
+        ~render_awaiter(void)
+        {
+            if (waiter)
+            {
+                owner.render_waiters.erase(job.ticket);
+            }
+        }
+
+        auto await_ready(void) const noexcept -> bool
+        {
+            return false;
+        }
+
+        auto await_suspend(std::coroutine_handle<> suspended) -> bool
+        {
+            if (!owner.renderer->try_submit(job))
+            {
+                // Queue full: pay for the render here rather than grow the
+                // backlog without bound.
+                rendered = run_render_job(job);
+                return false;
+            }
+            waiter = suspended;
+            owner.render_waiters.emplace(job.ticket, this);
+            ++owner.loop_stats.offloaded_renders;
+            return true;
+        }
+
+        auto await_resume(void) -> std::string
+        {
+            return std::move(rendered);
+        }
+    };
+
+    auto server::start_connection(client_connection &client) -> void
+    {
+        client.get_task() = serve_connection(client);
+        resume_connection(client, client.get_task().get_handle());
+    }
+
+    auto server::resume_connection(
+        client_connection      &client,
+        std::coroutine_handle<> waiter
+    ) -> void
+    {
+        int previous_fd = std::exchange(running_connection_fd, client.get_fd());
+        waiter.resume();
+        running_connection_fd = previous_fd;
+
+        // The coroutine has suspended again, so frames of connections it
+        // closed can go now.
+        if (running_connection_fd == -1)
+        {
+            closed_clients.clear();
+        }
+    }
+
+    auto server::serve_connection(client_connection &client) -> task<>
+    {
+        int client_fd = client.get_fd();
+        while (true)
+        {
+            // Handed-off connections may arrive with commands already
+            // buffered, so drain before the first wait.
+            co_await drain_read_buffer(client);
+            if (!client_connections.contains(client_fd))
+            {
+                co_return;
+            }
+            if (!replica_subscribers.empty())
+            {
+                publish_replication_events();
+                if (!client_connections.contains(client_fd))
+                {
+                    co_return;
+                }
+            }
+            co_await next_input(client);
+        }
+    }
+
+    auto server::next_input(client_connection &client) -> input_awaiter
+    {
+        return input_awaiter { client };
+    }
+
+    auto server::flush(client_connection &client) -> flush_awaiter
+    {
+        return flush_awaiter { client };
+    }
+
+    auto server::serve_get(client_connection &client, const message_filter &filter)
+        -> task<std::string>
+    {
+        message_snapshot snapshot;
+        {
+            auto lock = store.lock();
+            snapshot  = store.snapshot(filter);
+        }
+        co_return co_await render_snapshot(client, std::move(snapshot));
+    }
+
+    auto server::render_snapshot(client_connection &client, message_snapshot snapshot)
+        -> task<std::string>
+    {
+        if (!renderer || snapshot.size() < OFFLOAD_MIN_MESSAGES)
+        {
+            co_return snapshot.render();
+        }
+        co_return co_await render_on_worker(client, std::move(snapshot));
+    }
+
+    auto server::serve_compressed_get(client_connection &client) -> task<std::string>
+    {
+        uintmax_t        version;
+        message_snapshot snapshot;
+        {
+            auto lock = store.lock();
+            version   = store.event_count();
+            if (compressed_get_cache.version == version)
+            {
+                co_return compressed_get_cache.frame;
+            }
+            snapshot = store.snapshot(message_filter {});
+        }
+
+        // Deflating costs far more than rendering, so even small boards go to
+        // a worker; only a pool-less server pays for it on the loop.
+        std::string frame;
+        if (!renderer)
+        {
+            frame = make_compressed_frame(snapshot.render(), COMPRESSION_CACHED_LEVEL);
+        }
+        else
+        {
+            frame = co_await render_on_worker(
+                client,
+                std::move(snapshot),
+                COMPRESSION_CACHED_LEVEL
+            );
+        }
+
+        // Renders for the same miss may finish out of order; keep the newest.
+        if (!compressed_get_cache.version || *compressed_get_cache.version < version)
+        {
+            compressed_get_cache.version = version;
+            compressed_get_cache.frame   = frame;
+        }
+        co_return frame;
+    }
+
+    auto server::render_on_worker(
+        client_connection      &client,
+        message_snapshot      &&snapshot,
+        std::optional<int>      compression_level
+    ) -> render_awaiter
+    {
+        return render_awaiter(
+            *this,
+            client,
+            render_job {
+                client.get_fd(),
+                ++next_render_ticket,
+                std::move(snapshot),
+                compression_level,
+            }
+        );
+    }
+
+    auto server::handle_render_completions(void) -> void
+    {
+        for (render_result &result : renderer->take_results())
+        {
+            auto waiter_iterator = render_waiters.find(result.ticket);
+            if (waiter_iterator == render_waiters.end())
+            {
+                continue;
+            }
+            render_awaiter *awaiter = waiter_iterator->second;
+            render_waiters.erase(waiter_iterator);
+
+            awaiter->rendered = std::move(result.rendered);
+            resume_connection(awaiter->client, std::exchange(awaiter->waiter, nullptr));
+        }
+    }
+
+}
@@ -0,0 +1,346 @@
+#include <oreore/server.hpp>
+
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+namespace oreore
+{
+    auto server::adopt_handoff(handoff_state &&handoff)
+        -> std::expected<void, std::string>
+    {
+        {
+            auto             lock = store.lock();
+            std::string_view snapshot(handoff.store_snapshot);
+            while (!snapshot.empty())
+            {
+                size_t newline_pos = snapshot.find('\n');
+                auto   event = parse_replication_event(snapshot.substr(0, newline_pos));
+                if (!event)
+                {
+                    return std::unexpected(event.error());
+                }
+                if (auto apply_result = store.apply(*event); !apply_result)
+                {
+                    return std::unexpected(apply_result.error());
+                }
+                snapshot.remove_prefix(
+                    newline_pos == std::string_view::npos ? snapshot.size()
+                                                          : newline_pos + 1
+                );
+            }
+        }
+
+        for (client_connection &client : handoff.clients)
+        {
+            int      client_fd = client.get_fd();
+            uint32_t events    = EPOLLIN | EPOLLET;
+            if (!client.get_write_buffer().empty())
+            {
+                events                        |= EPOLLOUT;
+                client.is_writing_registered()  = true;
+            }
+            if (auto register_res = register_descriptor(client_fd, events);
+                !register_res)
+            {
+                std::cerr << "Dropping handed-off client: " << register_res.error()
+                          << std::endl;
+                continue;
+            }
+            if (client.get_replica_sequence())
+            {
+                replica_subscribers.insert(client_fd);
+            }
+            buffered_bytes += client.get_read_buffer().size()
+                            + client.get_write_buffer().size();
+            client_connections.emplace(client_fd, std::move(client));
+        }
+
+        std::cout << "Took over " << store.event_count() << " events and "
+                  << client_connections.size() << " connections." << std::endl;
+        return {};
+    }
+
+    auto server::write_handoff_state(std::span<client_connection *const> clients)
+        -> std::expected<handoff_state_file, std::string>
+    {
+        auto state = handoff_state_file::make(listener_fds.size());
+        if (!state)
+        {
+            return std::unexpected(state.error());
+        }
+
+        // The store goes out a chunk at a time, never as one text copy.
+        {
+            auto        lock = store.lock();
+            std::string events;
+            uintmax_t   sequence = 0;
+            while (true)
+            {
+                events.clear();
+                uintmax_t next = store.format_events(sequence, HANDOFF_CHUNK_SIZE, events);
+                if (next == sequence)
+                {
+                    break;
+                }
+                sequence = next;
+                if (auto result = state->append_store(events); !result)
+                {
+                    return std::unexpected(result.error());
+                }
+            }
+        }
+
+        for (client_connection *client : clients)
+        {
+            if (auto result = state->append_client(*client); !result)
+            {
+                return std::unexpected(result.error());
+            }
+        }
+        if (auto result = state->finish(); !result)
+        {
+            return std::unexpected(result.error());
+        }
+        return state;
+    }
+
+    auto server::handle_handoff_request(void) -> void
+    {
+        scoped_file_descriptor peer(accept4(
+            handoff_listener_fd.get(),
+            nullptr,
+            nullptr,
+            SOCK_NONBLOCK | SOCK_CLOEXEC
+        ));
+        if (peer.get() == -1)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                perror("handoff accept error");
+            }
+            return;
+        }
+        if (takeover)
+        {
+            std::cerr << "Hot restart refused: a takeover is already in progress."
+                      << std::endl;
+            return;
+        }
+
+        if (auto register_res = register_descriptor(peer.get(), EPOLLIN); !register_res)
+        {
+            std::cerr << "Hot restart aborted: " << register_res.error() << std::endl;
+            return;
+        }
+        takeover.emplace(std::move(peer));
+    }
+
+    auto server::handle_takeover_event(uint32_t events) -> void
+    {
+        if (takeover->get_phase() == handoff_phase::request && (events & EPOLLIN))
+        {
+            auto requested = takeover->receive_request();
+            if (!requested)
+            {
+                abort_takeover(requested.error());
+                return;
+            }
+            if (*requested)
+            {
+                std::cout << "Hot restart requested; finishing in-flight work."
+                          << std::endl;
+                set_accepting(false);
+                advance_takeover();
+            }
+            return;
+        }
+        if (takeover->get_phase() == handoff_phase::sending && (events & EPOLLOUT))
+        {
+            if (auto send_res = takeover->send_pending(); !send_res)
+            {
+                abort_takeover(send_res.error());
+                return;
+            }
+            if (takeover->get_phase() == handoff_phase::awaiting_ready)
+            {
+                modify_descriptor(takeover->get_fd(), EPOLLIN);
+            }
+            return;
+        }
+        if (takeover->get_phase() == handoff_phase::awaiting_ready && (events & EPOLLIN))
+        {
+            auto ready = takeover->receive_ready();
+            if (!ready)
+            {
+                abort_takeover(ready.error());
+                return;
+            }
+            if (*ready)
+            {
+                advance_takeover();
+            }
+            return;
+        }
+        // The peer says nothing else, so anything more is it going away.
+        if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        {
+            abort_takeover("replacement closed the handoff socket");
+        }
+    }
+
+    auto server::advance_takeover(void) -> void
+    {
+        if (takeover->has_expired(std::chrono::steady_clock::now()))
+        {
+            abort_takeover("timed out");
+            return;
+        }
+
+        // A connection parked on a render or a shard call still has its
+        // command in the read buffer; handed off now, the replacement would
+        // run it again. Resumed connections may start more work from input
+        // they already hold, so this waits until nothing is left.
+        if (takeover->get_phase() == handoff_phase::quiescing
+            && render_waiters.empty() && shard_waiters.empty()
+            && ready_shard_calls.empty())
+        {
+            std::vector<client_connection *> handed_off;
+            if (takeover->wants_clients())
+            {
+                for (auto &[client_fd, client] : client_connections)
+                {
+                    handed_off.push_back(&client);
+                }
+            }
+            auto state = write_handoff_state(handed_off);
+            if (!state)
+            {
+                abort_takeover(state.error());
+                return;
+            }
+            takeover->start_sending(listener_fds, std::move(*state), handed_off);
+            if (auto send_res = takeover->send_pending(); !send_res)
+            {
+                abort_takeover(send_res.error());
+                return;
+            }
+            if (takeover->get_phase() == handoff_phase::sending)
+            {
+                modify_descriptor(takeover->get_fd(), EPOLLIN | EPOLLOUT);
+            }
+            return;
+        }
+
+        // Only a replacement that is serving takes the old process down.
+        if (takeover->get_phase() == handoff_phase::released)
+        {
+            bool clients_handed_off = takeover->wants_clients();
+            std::cout << "Handed off " << listener_fds.size() << " listener(s) and "
+                      << (clients_handed_off ? client_connections.size() : 0)
+                      << " connections; draining." << std::endl;
+            unregister_descriptor(takeover->get_fd());
+            takeover.reset();
+            begin_drain(clients_handed_off);
+        }
+    }
+
+    auto server::abort_takeover(const std::string &reason) -> void
+    {
+        std::cerr << "Hot restart aborted: " << reason << std::endl;
+        bool output_held = is_handing_off_clients();
+        unregister_descriptor(takeover->get_fd());
+        takeover.reset();
+
+        // Edge-triggered: input and send space that arrived meanwhile raise
+        // no new event. Accepts resume with the next overload update.
+        std::vector<int> client_fds;
+        for (auto &[client_fd, client] : client_connections)
+        {
+            client_fds.push_back(client_fd);
+        }
+        for (int client_fd : client_fds)
+        {
+            auto client_iterator = client_connections.find(client_fd);
+            if (client_iterator != client_connections.end() && output_held)
+            {
+                handle_client_write(client_iterator->second);
+            }
+            client_iterator = client_connections.find(client_fd);
+            if (client_iterator != client_connections.end())
+            {
+                handle_client_read(client_iterator->second);
+            }
+        }
+        publish_replication_events();
+    }
+
+    auto server::is_handing_off(void) const -> bool
+    {
+        return takeover && takeover->get_phase() != handoff_phase::request;
+    }
+
+    auto server::is_handing_off_clients(void) const -> bool
+    {
+        return takeover && takeover->wants_clients()
+            && takeover->get_phase() >= handoff_phase::sending;
+    }
+
+    auto server::begin_drain(bool clients_handed_off) -> void
+    {
+        draining       = true;
+        if (board_mirror)
+        {
+            // Bring readers up to the final state and leave the segment
+            // for the replacement to retire once its own is under the name.
+            publish_shared_board();
+            board_mirror->hand_over();
+        }
+        drain_deadline = std::chrono::steady_clock::now()
+                       + std::chrono::seconds(DRAIN_TIMEOUT_SECONDS);
+
+        for (const scoped_file_descriptor &listener : listener_fds)
+        {
+            unregister_descriptor(listener.get());
+        }
+        listener_fds.clear();
+        unregister_descriptor(handoff_listener_fd.get());
+        handoff_listener_fd = scoped_file_descriptor();
+
+        if (is_follower())
+        {
+            if (primary_link->get_fd() != -1)
+            {
+                unregister_descriptor(primary_link->get_fd());
+            }
+            primary_link->disconnect();
+            unregister_descriptor(replication_timer_fd.get());
+        }
+
+        // The new process holds its own copies of handed-off sockets, so
+        // closing ours here leaves those connections open.
+        std::vector<int> client_fds;
+        for (auto &[client_fd, client] : client_connections)
+        {
+            client_fds.push_back(client_fd);
+        }
+        for (int client_fd : client_fds)
+        {
+            auto &client = client_connections.at(client_fd);
+            if (clients_handed_off || client.get_write_buffer().empty())
+            {
+                close_client(
+                    client_fd,
+                    clients_handed_off ? nullptr : "draining for hot restart"
+                );
+            }
+        }
+    }
+
+    auto server::drain_finished(void) const -> bool
+    {
+        return client_connections.empty()
+            || std::chrono::steady_clock::now() >= drain_deadline;
+    }
+
+}
@@ -0,0 +1,239 @@
+#include <oreore/server.hpp>
+
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+namespace oreore
+{
+    auto server::is_follower(void) const -> bool
+    {
+        return primary_link.has_value();
+    }
+
+    auto server::read_only_error(void) const -> std::string
+    {
+        return "ERR: Read-only replica. Send writes to primary "
+             + primary_link->get_address() + ".\n";
+    }
+
+    // --- Primary side ---
+    auto server::subscribe_replica(client_connection &client, uintmax_t from_sequence)
+        -> void
+    {
+        std::cout << "Replica " << client.get_peer_string() << " (socket "
+                  << client.get_fd() << ") subscribed from sequence "
+                  << from_sequence << std::endl;
+
+        client.get_replica_sequence() = from_sequence;
+        replica_subscribers.insert(client.get_fd());
+        queue_data_for_send(
+            client,
+            "OK: Replicating from sequence " + std::to_string(from_sequence)
+                + ".\n"
+        );
+        if (client_connections.contains(client.get_fd()))
+        {
+            pump_replica(client);
+        }
+    }
+
+    auto server::pump_replica(client_connection &client) -> void
+    {
+        auto &next_sequence = client.get_replica_sequence();
+        // Leave the backlog in the store until the replica drains what it
+        // already has, so a slow follower cannot balloon our memory.
+        if (!next_sequence
+            || client.get_write_buffer().size() >= REPLICA_CHUNK_BYTES)
+        {
+            return;
+        }
+
+        std::string chunk;
+        {
+            auto lock      = store.lock();
+            next_sequence  = store.format_events(
+                *next_sequence,
+                REPLICA_CHUNK_BYTES,
+                chunk
+            );
+        }
+        if (!chunk.empty())
+        {
+            queue_data_for_send(client, std::move(chunk));
+        }
+    }
+
+    auto server::publish_replication_events(void) -> void
+    {
+        // Subscribers catch up once a takeover is done with or aborted.
+        if (is_handing_off())
+        {
+            return;
+        }
+        // pump_replica may close a subscriber, so walk a snapshot.
+        std::vector<int> subscribers(
+            replica_subscribers.begin(),
+            replica_subscribers.end()
+        );
+        for (int subscriber_fd : subscribers)
+        {
+            auto client_iterator = client_connections.find(subscriber_fd);
+            if (client_iterator != client_connections.end())
+            {
+                pump_replica(client_iterator->second);
+            }
+        }
+    }
+
+    // --- Follower side ---
+    auto server::start_replication(void) -> void
+    {
+        auto connect_result = primary_link->start_connect();
+        if (!connect_result)
+        {
+            schedule_replication_retry(connect_result.error());
+            return;
+        }
+
+        auto register_result = register_descriptor(
+            primary_link->get_fd(),
+            EPOLLIN | EPOLLOUT | EPOLLET
+        );
+        if (!register_result)
+        {
+            schedule_replication_retry(register_result.error());
+        }
+    }
+
+    auto server::schedule_replication_retry(const std::string &reason) -> void
+    {
+        std::cerr << "Replication link to " << primary_link->get_address()
+                  << " down: " << reason << "; retrying in "
+                  << REPLICA_RETRY_SECONDS << "s" << std::endl;
+
+        if (primary_link->get_fd() != -1)
+        {
+            unregister_descriptor(primary_link->get_fd());
+        }
+        primary_link->disconnect();
+
+        itimerspec retry {};
+        retry.it_value.tv_sec = REPLICA_RETRY_SECONDS;
+        if (timerfd_settime(replication_timer_fd.get(), 0, &retry, nullptr) == -1)
+        {
+            perror("timerfd_settime error");
+        }
+    }
+
+    auto server::handle_replication_timer(void) -> void
+    {
+        uint64_t expirations;
+        while (read(replication_timer_fd.get(), &expirations, sizeof(expirations))
+               > 0)
+        {
+        }
+        start_replication();
+    }
+
+    auto server::handle_replication_link(uint32_t events) -> void
+    {
+        if (events & (EPOLLERR | EPOLLHUP))
+        {
+            schedule_replication_retry("EPOLLERR or EPOLLHUP");
+            return;
+        }
+
+        if (!primary_link->is_connected())
+        {
+            if (!(events & EPOLLOUT))
+            {
+                return;
+            }
+
+            uintmax_t next_sequence;
+            {
+                auto lock     = store.lock();
+                next_sequence = store.event_count();
+            }
+            auto finish_result = primary_link->finish_connect(next_sequence);
+            if (!finish_result)
+            {
+                schedule_replication_retry(finish_result.error());
+                return;
+            }
+            modify_descriptor(primary_link->get_fd(), EPOLLIN | EPOLLET);
+            std::cout << "Replicating from " << primary_link->get_address()
+                      << " starting at sequence " << next_sequence << std::endl;
+        }
+
+        if (!(events & EPOLLIN))
+        {
+            return;
+        }
+
+        char         buffer[BUFFER_SIZE];
+        std::string &accumulated_data = primary_link->get_read_buffer();
+        while (true)
+        {
+            ssize_t bytes_received
+                = recv(primary_link->get_fd(), buffer, sizeof(buffer), 0);
+            if (bytes_received > 0)
+            {
+                accumulated_data.append(buffer, bytes_received);
+                continue;
+            }
+            if (bytes_received == 0)
+            {
+                schedule_replication_retry("primary closed the connection");
+                return;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+            schedule_replication_retry(make_errno_message("recv error"));
+            return;
+        }
+
+        size_t consumed = 0;
+        {
+            auto   lock = store.lock();
+            size_t newline_pos;
+            while ((newline_pos = accumulated_data.find('\n', consumed))
+                   != std::string::npos)
+            {
+                std::string_view line(
+                    accumulated_data.data() + consumed,
+                    newline_pos - consumed
+                );
+                consumed = newline_pos + 1;
+
+                // The primary acknowledges the subscription before streaming.
+                if (line.starts_with("OK:"))
+                {
+                    continue;
+                }
+
+                auto event = parse_replication_event(line);
+                if (!event)
+                {
+                    lock.unlock();
+                    schedule_replication_retry(event.error());
+                    return;
+                }
+                if (auto apply_result = store.apply(*event); !apply_result)
+                {
+                    lock.unlock();
+                    schedule_replication_retry(apply_result.error());
+                    return;
+                }
+            }
+        }
+        accumulated_data.erase(0, consumed);
+
+        // Followers can themselves feed further replicas.
+        publish_replication_events();
+    }
+
+}
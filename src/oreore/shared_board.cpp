@@ -0,0 +1,355 @@
+#include <oreore/scoped_file_descriptor.hpp>
+#include <oreore/shared_board.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace oreore
+{
+    namespace
+    {
+        // The file behind a shared memory object name such as "/board".
+        auto shared_memory_path(std::string_view name) -> std::string
+        {
+            while (name.starts_with('/'))
+            {
+                name.remove_prefix(1);
+            }
+            return std::string(SHARED_MEMORY_DIRECTORY) + "/" + std::string(name);
+        }
+
+        // Marks whatever board is published under `name` as retired.
+        auto retire_published(int segment_fd) -> void
+        {
+            struct stat status {};
+            if (fstat(segment_fd, &status) == -1
+                || static_cast<size_t>(status.st_size) < sizeof(shared_board_header))
+            {
+                return;
+            }
+            void *segment = mmap(
+                nullptr,
+                sizeof(shared_board_header),
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED,
+                segment_fd,
+                0
+            );
+            if (segment == MAP_FAILED)
+            {
+                return;
+            }
+            auto *board = static_cast<shared_board_header *>(segment);
+            if (shared_load(board->magic, std::memory_order_acquire) == SHARED_BOARD_MAGIC)
+            {
+                shared_store(board->retired, 1, std::memory_order_release);
+            }
+            munmap(segment, sizeof(shared_board_header));
+        }
+    }
+
+    shared_board::shared_board(
+        char       *segment,
+        size_t      size,
+        std::string public_name,
+        std::string staged_name
+    )
+        : mapping(segment)
+        , mapping_size(size)
+        , name(std::move(public_name))
+        , staging_name(std::move(staged_name))
+        , live(false)
+        , handed_over(false)
+        , published_events(0)
+    {
+    }
+
+    shared_board::shared_board(shared_board &&other) noexcept
+        : mapping(std::exchange(other.mapping, nullptr))
+        , mapping_size(std::exchange(other.mapping_size, 0))
+        , name(std::move(other.name))
+        , staging_name(std::move(other.staging_name))
+        , live(other.live)
+        , handed_over(other.handed_over)
+        , published_events(other.published_events)
+        , record_offsets(std::move(other.record_offsets))
+    {
+    }
+
+    auto shared_board::operator=(shared_board &&other) noexcept -> shared_board &
+    {
+        if (this != &other)
+        {
+            release();
+            mapping          = std::exchange(other.mapping, nullptr);
+            mapping_size     = std::exchange(other.mapping_size, 0);
+            name             = std::move(other.name);
+            staging_name     = std::move(other.staging_name);
+            live             = other.live;
+            handed_over      = other.handed_over;
+            published_events = other.published_events;
+            record_offsets   = std::move(other.record_offsets);
+        }
+        return *this;
+    }
+
+    shared_board::~shared_board(void)
+    {
+        release();
+    }
+
+    auto shared_board::release(void) -> void
+    {
+        if (!mapping)
+        {
+            return;
+        }
+        if (!live)
+        {
+            shm_unlink(staging_name.c_str());
+        }
+        else if (!handed_over)
+        {
+            retire();
+        }
+        munmap(std::exchange(mapping, nullptr), mapping_size);
+    }
+
+    auto shared_board::make(const std::string &name, size_t capacity)
+        -> std::expected<shared_board, std::string>
+    {
+        // Step 1: Create the segment under a name only this process uses.
+        // Whatever is published under `name` keeps serving its readers.
+        std::string staging_name = name + "." + std::to_string(getpid());
+        shm_unlink(staging_name.c_str());
+        scoped_file_descriptor segment_fd(shm_open(
+            staging_name.c_str(),
+            O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+            0644
+        ));
+        if (segment_fd.get() == -1)
+        {
+            return std::unexpected(
+                make_errno_message("shm_open " + staging_name + " failed")
+            );
+        }
+        auto fail = [&staging_name](const std::string &what)
+            -> std::unexpected<std::string>
+        {
+            std::string error = make_errno_message(what + " " + staging_name + " failed");
+            shm_unlink(staging_name.c_str());
+            return std::unexpected(error);
+        };
+
+        // Step 2: Size and map it
+        size_t index_slots = shared_board_index_slots(capacity);
+        size_t size        = shared_board_records_offset(index_slots) + capacity;
+        if (ftruncate(segment_fd.get(), static_cast<off_t>(size)) == -1)
+        {
+            return fail("ftruncate");
+        }
+        void *segment = mmap(
+            nullptr,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            segment_fd.get(),
+            0
+        );
+        if (segment == MAP_FAILED)
+        {
+            return fail("mmap");
+        }
+
+        // Step 3: Write the header
+        shared_board board(static_cast<char *>(segment), size, name, staging_name);
+        shared_board_header &fresh = board.header();
+        fresh.layout_version       = SHARED_BOARD_LAYOUT_VERSION;
+        fresh.header_size          = sizeof(shared_board_header);
+        fresh.capacity             = capacity;
+        fresh.index_slots          = index_slots;
+        shared_store(fresh.magic, SHARED_BOARD_MAGIC, std::memory_order_release);
+        return board;
+    }
+
+    auto shared_board::header(void) -> shared_board_header &
+    {
+        return *reinterpret_cast<shared_board_header *>(mapping);
+    }
+
+    auto shared_board::records(void) -> char *
+    {
+        return mapping + shared_board_records_offset(header().index_slots);
+    }
+
+    auto shared_board::append_record(const message &msg) -> bool
+    {
+        shared_board_header &board = header();
+        uint64_t             used  = shared_load(board.used, std::memory_order_relaxed);
+        size_t size = shared_board_record_size(msg.sender_ip.size(), msg.text.size());
+        if (size > board.capacity - used)
+        {
+            return false;
+        }
+
+        // Past `message_count`, so no reader looks at these bytes yet.
+        char *destination     = records() + used;
+        auto *record          = reinterpret_cast<shared_board_record *>(destination);
+        record->id            = msg.id;
+        record->sequence      = 0;
+        record->sender_length = static_cast<uint32_t>(msg.sender_ip.size());
+        record->text_length   = static_cast<uint32_t>(msg.text.size());
+        destination += sizeof(shared_board_record);
+        std::memcpy(destination, msg.sender_ip.data(), msg.sender_ip.size());
+        std::memcpy(
+            destination + msg.sender_ip.size(),
+            msg.text.data(),
+            msg.text.size()
+        );
+
+        // Every record takes at least sizeof(shared_board_record), so the
+        // index always has a slot for it.
+        size_t position = record_offsets.size();
+        if (position % SHARED_BOARD_INDEX_STRIDE == 0)
+        {
+            auto *index
+                = reinterpret_cast<uint64_t *>(mapping + sizeof(shared_board_header));
+            index[position / SHARED_BOARD_INDEX_STRIDE] = used;
+        }
+        record_offsets.push_back(used);
+        update_record(position, msg);
+
+        shared_store(board.used, used + size, std::memory_order_relaxed);
+        shared_store(
+            board.message_count,
+            record_offsets.size(),
+            std::memory_order_release
+        );
+        return true;
+    }
+
+    auto shared_board::update_record(size_t position, const message &msg) -> void
+    {
+        auto *record
+            = reinterpret_cast<shared_board_record *>(records() + record_offsets[position]);
+        uint64_t sequence = shared_load(record->sequence, std::memory_order_relaxed);
+        shared_store(record->sequence, sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        shared_store(
+            record->reaction,
+            static_cast<uint64_t>(msg.reaction.load(std::memory_order_relaxed)),
+            std::memory_order_relaxed
+        );
+        shared_store(
+            record->happy,
+            msg.happy_count.load(std::memory_order_relaxed),
+            std::memory_order_relaxed
+        );
+        shared_store(
+            record->sad,
+            msg.sad_count.load(std::memory_order_relaxed),
+            std::memory_order_relaxed
+        );
+
+        shared_store(record->sequence, sequence + 2, std::memory_order_release);
+    }
+
+    auto shared_board::is_behind(const message_store &store) const -> bool
+    {
+        return store.event_count() != published_events;
+    }
+
+    auto shared_board::publish(const message_store &store) -> void
+    {
+        if (!is_behind(store))
+        {
+            return;
+        }
+
+        shared_board_header &board = header();
+        published_events           = store.visit_events(
+            published_events,
+            [this, &board](replication_event_kind kind, size_t position, const message &msg)
+            {
+                if (kind == replication_event_kind::post)
+                {
+                    // Positions are dense, so once one post does not fit
+                    // none after it is published either.
+                    if (position == record_offsets.size() && !append_record(msg))
+                    {
+                        shared_store(board.truncated, 1, std::memory_order_relaxed);
+                    }
+                }
+                else if (position < record_offsets.size())
+                {
+                    update_record(position, msg);
+                }
+            }
+        );
+        shared_store(board.board_version, published_events, std::memory_order_release);
+    }
+
+    auto shared_board::go_live(void) -> std::expected<void, std::string>
+    {
+        if (live)
+        {
+            return {};
+        }
+
+        // rename() swaps the name over in one step, so a reader opening it
+        // gets either the old board or this one, never neither.
+        scoped_file_descriptor previous_fd(shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0));
+        if (std::rename(
+                shared_memory_path(staging_name).c_str(),
+                shared_memory_path(name).c_str()
+            )
+            == -1)
+        {
+            return std::unexpected(
+                make_errno_message("rename " + staging_name + " to " + name + " failed")
+            );
+        }
+        live = true;
+
+        // Readers of the replaced board learn to open the name again.
+        if (previous_fd.get() != -1)
+        {
+            retire_published(previous_fd.get());
+        }
+        return {};
+    }
+
+    auto shared_board::hand_over(void) -> void
+    {
+        handed_over = true;
+    }
+
+    auto shared_board::retire(void) -> void
+    {
+        shared_store(header().retired, 1, std::memory_order_release);
+    }
+
+    auto shared_board::get_used_bytes(void) const -> uint64_t
+    {
+        return shared_load(
+            reinterpret_cast<const shared_board_header *>(mapping)->used,
+            std::memory_order_relaxed
+        );
+    }
+
+    auto shared_board::is_truncated(void) const -> bool
+    {
+        return shared_load(
+                   reinterpret_cast<const shared_board_header *>(mapping)->truncated,
+                   std::memory_order_relaxed
+               )
+            != 0;
+    }
+
+}
@@ -0,0 +1,129 @@
+#include <oreore/message.hpp>
+#include <oreore/socket_tuning.hpp>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+namespace oreore
+{
+    namespace
+    {
+        auto set_int_option(int fd, int level, int name, int value, const char *label)
+            -> std::expected<void, std::string>
+        {
+            if (setsockopt(fd, level, name, &value, sizeof(value)) == -1)
+            {
+                return std::unexpected(
+                    make_errno_message(std::string("setsockopt(") + label + ") failed")
+                );
+            }
+            return {};
+        }
+    }
+
+    auto parse_latency_profile(std::string_view name)
+        -> std::optional<latency_profile>
+    {
+        if (name == "standard")
+        {
+            return latency_profile::standard;
+        }
+        if (name == "low-latency")
+        {
+            return latency_profile::low_latency;
+        }
+        return std::nullopt;
+    }
+
+    auto parse_listener_distribution(std::string_view name)
+        -> std::optional<listener_distribution>
+    {
+        if (name == "shared")
+        {
+            return listener_distribution::shared;
+        }
+        if (name == "exclusive")
+        {
+            return listener_distribution::exclusive;
+        }
+        if (name == "reuseport")
+        {
+            return listener_distribution::reuseport;
+        }
+        return std::nullopt;
+    }
+
+    auto tune_listener(int listener_fd, latency_profile profile)
+        -> std::expected<void, std::string>
+    {
+        if (profile != latency_profile::low_latency)
+        {
+            return {};
+        }
+
+        if (auto result = set_int_option(
+                listener_fd,
+                SOL_SOCKET,
+                SO_RCVBUF,
+                LOW_LATENCY_SOCKET_BUFFER_SIZE,
+                "SO_RCVBUF"
+            );
+            !result)
+        {
+            return result;
+        }
+        if (auto result = set_int_option(
+                listener_fd,
+                SOL_SOCKET,
+                SO_SNDBUF,
+                LOW_LATENCY_SOCKET_BUFFER_SIZE,
+                "SO_SNDBUF"
+            );
+            !result)
+        {
+            return result;
+        }
+        return set_int_option(
+            listener_fd,
+            IPPROTO_TCP,
+            TCP_DEFER_ACCEPT,
+            DEFER_ACCEPT_SECONDS,
+            "TCP_DEFER_ACCEPT"
+        );
+    }
+
+    auto tune_connection(int client_fd, latency_profile profile)
+        -> std::expected<void, std::string>
+    {
+        if (profile != latency_profile::low_latency)
+        {
+            return {};
+        }
+
+        if (auto result
+            = set_int_option(client_fd, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+            !result)
+        {
+            return result;
+        }
+        rearm_quick_ack(client_fd);
+        // Raising SO_BUSY_POLL above net.core.busy_read needs CAP_NET_ADMIN;
+        // the profile still helps without it, so callers treat this failure
+        // as a warning.
+        return set_int_option(
+            client_fd,
+            SOL_SOCKET,
+            SO_BUSY_POLL,
+            LOW_LATENCY_BUSY_POLL_US,
+            "SO_BUSY_POLL"
+        );
+    }
+
+    auto rearm_quick_ack(int client_fd) -> void
+    {
+        int enabled = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_QUICKACK, &enabled, sizeof(enabled));
+    }
+
+}
@@ -0,0 +1,175 @@
+#include <oreore/message.hpp>
+#include <oreore/trace_recorder.hpp>
+
+#include <fcntl.h>
+#include <iostream>
+
+namespace oreore
+{
+    namespace
+    {
+        auto append_json_string(std::string &out, std::string_view text) -> void
+        {
+            static constexpr char hex_digits[] = "0123456789abcdef";
+
+            out += '"';
+            for (char c : text)
+            {
+                auto byte = static_cast<unsigned char>(c);
+                if (byte == '"' || byte == '\\')
+                {
+                    out += '\\';
+                    out += c;
+                }
+                else if (byte < 0x20)
+                {
+                    out += "\\u00";
+                    out += hex_digits[byte >> 4];
+                    out += hex_digits[byte & 0xF];
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        auto microseconds_of(trace_recorder::clock::duration duration) -> long long
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                .count();
+        }
+    }
+
+    trace_recorder::trace_recorder(scoped_file_descriptor &&trace_file, uint32_t every)
+        : file(std::move(trace_file))
+        , sample_every(every)
+        , sample_counter(0)
+        , process_id(getpid())
+    {
+    }
+
+    trace_recorder::~trace_recorder(void)
+    {
+        flush();
+    }
+
+    auto trace_recorder::make(const std::string &path, uint32_t every)
+        -> std::expected<std::unique_ptr<trace_recorder>, std::string>
+    {
+        scoped_file_descriptor trace_file(
+            open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+        );
+        if (trace_file.get() == -1)
+        {
+            return std::unexpected(make_errno_message("open " + path + " failed"));
+        }
+
+        std::unique_ptr<trace_recorder> recorder(
+            new trace_recorder(std::move(trace_file), every)
+        );
+        recorder->pending = "[\n";
+        recorder->flush();
+        return recorder;
+    }
+
+    auto trace_recorder::sample(void) -> bool
+    {
+        return ++sample_counter % sample_every == 0;
+    }
+
+    auto trace_recorder::record(
+        std::string_view  name,
+        clock::time_point start,
+        clock::time_point end,
+        int               connection_fd,
+        std::string_view  detail
+    ) -> void
+    {
+        pending += "{\"name\":";
+        append_json_string(pending, name);
+        pending += ",\"cat\":\"oreore\",\"ph\":\"X\",\"ts\":";
+        pending += std::to_string(microseconds_of(start.time_since_epoch()));
+        pending += ",\"dur\":";
+        pending += std::to_string(microseconds_of(end - start));
+        pending += ",\"pid\":";
+        pending += std::to_string(process_id);
+        pending += ",\"tid\":";
+        pending += std::to_string(connection_fd);
+        if (!detail.empty())
+        {
+            pending += ",\"args\":{\"detail\":";
+            append_json_string(pending, detail);
+            pending += '}';
+        }
+        pending += "},\n";
+
+        if (pending.size() >= TRACE_FLUSH_BYTES)
+        {
+            flush();
+        }
+    }
+
+    auto trace_recorder::flush(void) -> void
+    {
+        size_t written = 0;
+        while (written < pending.size())
+        {
+            ssize_t result
+                = write(file.get(), pending.data() + written, pending.size() - written);
+            if (result == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                // Tracing is best effort; drop the batch rather than stall.
+                std::cerr << make_errno_message("trace write failed") << std::endl;
+                break;
+            }
+            written += static_cast<size_t>(result);
+        }
+        pending.clear();
+    }
+
+    trace_span::trace_span(trace_recorder *target, std::string_view span_name, int fd)
+        : recorder(target)
+        , name(span_name)
+        , connection_fd(fd)
+    {
+        if (recorder)
+        {
+            start = trace_recorder::clock::now();
+        }
+    }
+
+    trace_span::~trace_span(void)
+    {
+        end();
+    }
+
+    auto trace_span::end(void) -> void
+    {
+        if (recorder)
+        {
+            recorder->record(
+                name,
+                start,
+                trace_recorder::clock::now(),
+                connection_fd,
+                detail
+            );
+            recorder = nullptr;
+        }
+    }
+
+    auto trace_span::set_detail(std::string_view text) -> void
+    {
+        if (recorder)
+        {
+            detail = text;
+        }
+    }
+
+}
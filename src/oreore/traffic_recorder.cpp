@@ -0,0 +1,122 @@
+#include <oreore/message.hpp>
+#include <oreore/traffic_recorder.hpp>
+
+#include <algorithm>
+#include <fcntl.h>
+#include <iostream>
+
+namespace oreore
+{
+    traffic_recorder::traffic_recorder(scoped_file_descriptor &&record_file)
+        : file(std::move(record_file))
+        , next_connection(0)
+        , last_record(clock::now())
+        , recorded_commands(0)
+    {
+    }
+
+    traffic_recorder::~traffic_recorder(void)
+    {
+        flush();
+    }
+
+    auto traffic_recorder::make(const std::string &path)
+        -> std::expected<std::unique_ptr<traffic_recorder>, std::string>
+    {
+        scoped_file_descriptor record_file(
+            open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+        );
+        if (record_file.get() == -1)
+        {
+            return std::unexpected(make_errno_message("open " + path + " failed"));
+        }
+
+        std::unique_ptr<traffic_recorder> recorder(
+            new traffic_recorder(std::move(record_file))
+        );
+        recorder->pending = TRAFFIC_MAGIC;
+        recorder->flush();
+        return recorder;
+    }
+
+    auto traffic_recorder::append(
+        traffic_kind     kind,
+        uint32_t         connection,
+        std::string_view payload
+    ) -> void
+    {
+        auto now   = clock::now();
+        auto delay = std::chrono::duration_cast<std::chrono::microseconds>(
+                         now - std::exchange(last_record, now)
+        )
+                         .count();
+        encode_traffic_record(
+            pending,
+            kind,
+            connection,
+            static_cast<uint32_t>(std::clamp<long long>(delay, 0, UINT32_MAX)),
+            payload
+        );
+
+        if (pending.size() >= TRAFFIC_FLUSH_BYTES)
+        {
+            flush();
+        }
+    }
+
+    auto traffic_recorder::record(
+        const client_connection &client,
+        traffic_kind             kind,
+        std::string_view         payload
+    ) -> void
+    {
+        auto [connection_iterator, inserted]
+            = connections.try_emplace(client.get_fd(), next_connection);
+        if (inserted)
+        {
+            ++next_connection;
+            append(traffic_kind::open, connection_iterator->second, client.get_peer_string());
+        }
+        append(kind, connection_iterator->second, payload);
+        ++recorded_commands;
+    }
+
+    auto traffic_recorder::record_close(int connection_fd) -> void
+    {
+        auto connection_iterator = connections.find(connection_fd);
+        if (connection_iterator == connections.end())
+        {
+            return;
+        }
+        append(traffic_kind::close, connection_iterator->second, {});
+        connections.erase(connection_iterator);
+    }
+
+    auto traffic_recorder::flush(void) -> void
+    {
+        size_t written = 0;
+        while (written < pending.size())
+        {
+            ssize_t result
+                = write(file.get(), pending.data() + written, pending.size() - written);
+            if (result == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                // Recording is best effort; drop the batch rather than stall.
+                std::cerr << make_errno_message("record write failed") << std::endl;
+                break;
+            }
+            written += static_cast<size_t>(result);
+        }
+        pending.clear();
+    }
+
+    auto traffic_recorder::get_recorded_commands(void) const -> uint64_t
+    {
+        return recorded_commands;
+    }
+
+}
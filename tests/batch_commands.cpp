@@ -0,0 +1,122 @@
+// Checks BATCH and MPOST replies line up with what was sent: a GET inside a
+// BATCH sees exactly the lines before it, even when the render goes to a
+// worker, an oversized BATCH is dropped as a whole, through its END, and a
+// blank MPOST line counts as a message and is refused by its number.
+//
+//   batch_commands <server binary>
+
+#include "test_process.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    using test_process::connect_with_retry;
+    using test_process::exchange;
+    using test_process::spawn;
+
+    inline constexpr const char PORT[] = "19734";
+    // Past OFFLOAD_MIN_MESSAGES, so a full GET renders on a worker.
+    inline constexpr size_t BOARD_SIZE = 3000;
+    // One past MAX_BATCH_SIZE.
+    inline constexpr size_t OVERSIZED_BATCH = 4097;
+
+    auto count_lines(std::string_view text) -> size_t
+    {
+        size_t lines = 0;
+        for (char byte : text)
+        {
+            lines += byte == '\n';
+        }
+        return lines;
+    }
+
+    auto batch_get_sees_earlier_lines(int fd) -> bool
+    {
+        std::string posts = "MPOST " + std::to_string(BOARD_SIZE) + "\n";
+        for (size_t index = 0; index < BOARD_SIZE; ++index)
+        {
+            posts += "m" + std::to_string(index) + "\n";
+        }
+        if (!exchange(fd, posts, 1).starts_with("OK:"))
+        {
+            std::cerr << "MPOST failed\n";
+            return false;
+        }
+
+        // POST, full GET, POST, then a GET that finds nothing.
+        size_t      expected = 1 + (BOARD_SIZE + 1) + 1 + 1;
+        std::string reply    = exchange(
+            fd,
+            "BATCH\nPOST before\nGET\nPOST after\nGET FROM 192.0.2.1\nEND\n",
+            expected
+        );
+        if (count_lines(reply) != expected
+            || reply.find("\"before\"") == std::string::npos
+            || reply.find("\"after\"") != std::string::npos
+            || !reply.ends_with("No messages match.\n"))
+        {
+            std::cerr << "BATCH with GETs replied " << count_lines(reply) << " lines\n";
+            return false;
+        }
+        return true;
+    }
+
+    auto oversized_batch_is_dropped(int fd) -> bool
+    {
+        std::string batch = "BATCH\n";
+        for (size_t index = 0; index < OVERSIZED_BATCH + 10; ++index)
+        {
+            batch += "POST dropped\n";
+        }
+        batch += "END\nSEARCH dropped\n";
+
+        std::string reply = exchange(fd, batch, 2);
+        if (reply != "ERR: BATCH exceeds 4096 commands; discarded.\n"
+                     "No messages match.\n")
+        {
+            std::cerr << "oversized BATCH replied:\n" << reply.substr(0, 200);
+            return false;
+        }
+        return true;
+    }
+
+    auto blank_mpost_line_is_refused(int fd) -> bool
+    {
+        // Had the blank line been skipped, "SEARCH third" would be posted as
+        // the third message.
+        std::string reply = exchange(fd, "MPOST 3\nfirst\n\nthird\nSEARCH third\n", 2);
+        if (reply != "ERR: Batch message 2: Message is empty.\nNo messages match.\n")
+        {
+            std::cerr << "MPOST with a blank line replied:\n" << reply;
+            return false;
+        }
+        return true;
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <server binary>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    pid_t server = spawn(argv[1], { PORT, "--render-workers", "2" });
+    int   fd     = connect_with_retry(PORT);
+
+    bool passed = fd >= 0 && batch_get_sees_earlier_lines(fd)
+               && oversized_batch_is_dropped(fd) && blank_mpost_line_is_refused(fd);
+
+    close(fd);
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+// Blocks freed on another thread must go back to the pool that carved them:
+// the owner reuses them instead of carving new slabs, and once it has taken
+// them back its in-use counts return to zero. The second half frees on one
+// thread while the owner keeps allocating, so returns race the reclaim.
+//
+//   buffer_pool_cross_thread
+
+#include <oreore/buffer_pool.hpp>
+
+#include <bit>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using oreore::buffer_pool;
+
+    // One per size class boundary region, plus one past the largest class.
+    inline constexpr size_t SIZES[]         = { 64, 1000, 65536, 100000 };
+    inline constexpr size_t BLOCKS_PER_SIZE = 500;
+    inline constexpr size_t RACE_ROUNDS     = 20000;
+
+    using block_list = std::vector<std::pair<void *, size_t>>;
+
+    auto free_on_other_thread(const block_list &blocks) -> void
+    {
+        std::thread(
+            [&blocks]
+            {
+                for (auto [block, bytes] : blocks)
+                {
+                    buffer_pool::local().deallocate(block, bytes);
+                }
+            }
+        ).join();
+    }
+
+    auto nothing_in_use(const buffer_pool &pool) -> bool
+    {
+        auto stats = pool.get_stats();
+        for (const auto &size_class : stats.classes)
+        {
+            if (size_class.in_use != 0)
+            {
+                std::cerr << size_class.in_use << " blocks of " << size_class.block_size
+                          << " bytes still in use\n";
+                return false;
+            }
+        }
+        if (stats.oversize_in_use != 0)
+        {
+            std::cerr << stats.oversize_in_use << " oversize blocks still in use\n";
+            return false;
+        }
+        return true;
+    }
+
+    auto returned_blocks_are_reused(buffer_pool &pool) -> bool
+    {
+        block_list       blocks;
+        std::set<void *> pooled;
+        for (size_t bytes : SIZES)
+        {
+            for (size_t count = 0; count < BLOCKS_PER_SIZE; ++count)
+            {
+                void *block = pool.allocate(bytes);
+                blocks.emplace_back(block, bytes);
+                if (bytes <= 65536)
+                {
+                    pooled.insert(block);
+                }
+            }
+        }
+        size_t slabs = pool.get_stats().slab_count;
+
+        free_on_other_thread(blocks);
+        if (pool.get_stats().oversize_in_use != 0)
+        {
+            std::cerr << "oversize blocks freed elsewhere still counted\n";
+            return false;
+        }
+
+        for (auto &[block, bytes] : blocks)
+        {
+            block = pool.allocate(bytes);
+            if (bytes <= 65536 && !pooled.contains(block))
+            {
+                std::cerr << "a " << bytes << "-byte block was carved anew\n";
+                return false;
+            }
+        }
+        if (pool.get_stats().slab_count != slabs)
+        {
+            std::cerr << "returned blocks were not reused; new slabs carved\n";
+            return false;
+        }
+
+        for (auto [block, bytes] : blocks)
+        {
+            pool.deallocate(block, bytes);
+        }
+        return nothing_in_use(pool);
+    }
+
+    auto returns_race_the_owner(buffer_pool &pool) -> bool
+    {
+        std::mutex handed_lock;
+        block_list handed;
+        bool       done = false;
+
+        std::thread freer(
+            [&]
+            {
+                block_list batch;
+                while (true)
+                {
+                    {
+                        std::lock_guard guard(handed_lock);
+                        batch.swap(handed);
+                        if (batch.empty() && done)
+                        {
+                            return;
+                        }
+                    }
+                    for (auto [block, bytes] : batch)
+                    {
+                        buffer_pool::local().deallocate(block, bytes);
+                    }
+                    batch.clear();
+                }
+            }
+        );
+
+        // The owner never frees here, so every allocation past the first
+        // slab's worth has to come back through the return list.
+        for (size_t round = 0; round < RACE_ROUNDS; ++round)
+        {
+            size_t bytes = SIZES[round % 3];
+            void  *block = pool.allocate(bytes);
+            std::lock_guard guard(handed_lock);
+            handed.emplace_back(block, bytes);
+        }
+        {
+            std::lock_guard guard(handed_lock);
+            done = true;
+        }
+        freer.join();
+
+        // Only an allocation that finds its free list empty drains the
+        // return list, so use up each free list first.
+        for (size_t index = 0; index < 3; ++index)
+        {
+            size_t bytes = SIZES[index];
+            size_t free  = 0;
+            for (const auto &size_class : pool.get_stats().classes)
+            {
+                if (size_class.block_size == std::bit_ceil(bytes))
+                {
+                    free = size_class.free;
+                }
+            }
+            block_list drained;
+            for (size_t count = 0; count <= free; ++count)
+            {
+                drained.emplace_back(pool.allocate(bytes), bytes);
+            }
+            for (auto [block, size] : drained)
+            {
+                pool.deallocate(block, size);
+            }
+        }
+        return nothing_in_use(pool);
+    }
+}
+
+auto main(void) -> int
+{
+    buffer_pool &pool = buffer_pool::local();
+
+    bool passed = returned_blocks_are_reused(pool) && returns_race_the_owner(pool);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,89 @@
+// Posts a message with quotes and a backslash through a router, once with
+// POST and once with MPOST, and checks the shard stored both the same way:
+// normalized exactly once, whichever path the text took.
+//
+//   cluster_mpost <server binary>
+
+#include "test_process.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    using test_process::connect_with_retry;
+    using test_process::exchange;
+    using test_process::spawn;
+
+    inline constexpr const char SHARD_PORT[]  = "19731";
+    inline constexpr const char ROUTER_PORT[] = "19730";
+    inline constexpr const char SECRET[]      = "cluster-mpost";
+
+    // The Msg field of one "ID: ..." line.
+    auto message_field(std::string_view line) -> std::string_view
+    {
+        size_t position = line.find("Msg: ");
+        return position == std::string_view::npos ? std::string_view {}
+                                                  : line.substr(position + 5);
+    }
+
+    auto run(int router_fd) -> bool
+    {
+        constexpr std::string_view text = R"(say "hi" \ back)";
+
+        std::string posted = exchange(router_fd, "POST " + std::string(text) + "\n", 1);
+        std::string batched
+            = exchange(router_fd, "MPOST 1\n" + std::string(text) + "\n", 1);
+        if (!posted.starts_with("OK:") || !batched.starts_with("OK:"))
+        {
+            std::cerr << "post failed: " << posted << batched;
+            return false;
+        }
+
+        std::string      board = exchange(router_fd, "GET\n", 2);
+        std::string_view first(board);
+        size_t           newline = first.find('\n');
+        std::string_view second  = first.substr(newline + 1);
+        first                    = first.substr(0, newline);
+        second                   = second.substr(0, second.find('\n'));
+        if (message_field(first).empty() || message_field(first) != message_field(second))
+        {
+            std::cerr << "POST and MPOST stored different text:\n" << board;
+            return false;
+        }
+        return true;
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <server binary>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    pid_t shard
+        = spawn(argv[1], { SHARD_PORT, "--shard", "0", "--cluster-secret", SECRET });
+    int probe = connect_with_retry(SHARD_PORT);
+    close(probe);
+    pid_t router = spawn(
+        argv[1],
+        { ROUTER_PORT, "--route", "127.0.0.1:19731", "--cluster-secret", SECRET }
+    );
+    int router_fd = connect_with_retry(ROUTER_PORT);
+
+    bool passed = probe >= 0 && router_fd >= 0 && run(router_fd);
+
+    close(router_fd);
+    kill(router, SIGTERM);
+    kill(shard, SIGTERM);
+    waitpid(router, nullptr, 0);
+    waitpid(shard, nullptr, 0);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,140 @@
+// Checks that a shard node takes routed frames, which name their own sender,
+// only from a connection that presented the cluster secret: a plain BINARY
+// client's routed POST is refused and stores nothing, a wrong secret gets
+// the connection closed, and the right one is accepted.
+//
+//   cluster_routed_auth <server binary>
+
+#include "test_process.hpp"
+
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    using test_process::connect_with_retry;
+    using test_process::exchange;
+    using test_process::peer_closed;
+    using test_process::receive_at_least;
+    using test_process::spawn;
+
+    inline constexpr const char SHARD_PORT[] = "19732";
+    inline constexpr const char SECRET[]     = "routed-auth";
+
+    inline constexpr uint8_t ROUTED       = 0x06;
+    inline constexpr uint8_t ROUTER_HELLO = 0x07;
+    inline constexpr size_t  HEADER_SIZE  = 12;
+
+    auto append_le32(std::string &out, uint32_t value) -> void
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    auto frame(uint8_t opcode, uint32_t request_id, std::string_view payload)
+        -> std::string
+    {
+        std::string out;
+        out.push_back(static_cast<char>(opcode));
+        out.append(3, '\0');
+        append_le32(out, request_id);
+        append_le32(out, static_cast<uint32_t>(payload.size()));
+        out.append(payload);
+        return out;
+    }
+
+    auto routed_post(std::string_view sender, std::string_view text) -> std::string
+    {
+        std::string payload(1, static_cast<char>(sender.size()));
+        payload.append(sender);
+        payload.append("POST ").append(text);
+        return frame(ROUTED, 1, payload);
+    }
+
+    // Sends `request` and returns the status byte of the reply frame, or -1.
+    auto frame_status(int fd, const std::string &request) -> int
+    {
+        send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+        std::string reply;
+        receive_at_least(fd, reply, HEADER_SIZE);
+        return reply.size() < HEADER_SIZE ? -1 : static_cast<uint8_t>(reply[1]);
+    }
+
+    auto open_binary(void) -> int
+    {
+        int fd = connect_with_retry(SHARD_PORT);
+        if (fd >= 0 && !exchange(fd, "BINARY\n", 1).starts_with("OK:"))
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    auto run(void) -> bool
+    {
+        int plain = open_binary();
+        if (plain < 0 || frame_status(plain, routed_post("6.6.6.6", "spoofed")) != 1)
+        {
+            std::cerr << "a plain client's routed frame was not refused\n";
+            return false;
+        }
+        close(plain);
+
+        int impostor = open_binary();
+        send(impostor, frame(ROUTER_HELLO, 0, "guess").data(), HEADER_SIZE + 5, 0);
+        if (impostor < 0 || !peer_closed(impostor))
+        {
+            std::cerr << "a wrong cluster secret was not refused\n";
+            return false;
+        }
+        close(impostor);
+
+        int         router = open_binary();
+        std::string hello  = frame(ROUTER_HELLO, 0, SECRET);
+        if (router < 0 || frame_status(router, hello) != 0
+            || frame_status(router, routed_post("10.0.0.1", "routed")) != 0)
+        {
+            std::cerr << "the router's routed frame was refused\n";
+            return false;
+        }
+        close(router);
+
+        int         reader = connect_with_retry(SHARD_PORT);
+        std::string board  = exchange(reader, "GET\n", 1);
+        close(reader);
+        if (board.find("10.0.0.1") == std::string::npos
+            || board.find("6.6.6.6") != std::string::npos)
+        {
+            std::cerr << "unexpected board:\n" << board;
+            return false;
+        }
+        return true;
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <server binary>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    pid_t shard
+        = spawn(argv[1], { SHARD_PORT, "--shard", "0", "--cluster-secret", SECRET });
+
+    bool passed = run();
+
+    kill(shard, SIGTERM);
+    waitpid(shard, nullptr, 0);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
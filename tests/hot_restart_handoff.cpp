@@ -0,0 +1,142 @@
+// Hot-restarts the server twice with --takeover-clients while two clients
+// stay connected: one idle, one with half a command sent. Each old process
+// must exit cleanly once the new one has the listener, the board and its
+// reactions must carry over, and both clients must keep working, the half
+// command finishing on the new process. The second hop hands off what the
+// first one received, so state makes the whole round trip.
+//
+//   hot_restart_handoff <server binary>
+
+#include "test_process.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    using test_process::connect_with_retry;
+    using test_process::exchange;
+    using test_process::spawn;
+    using test_process::wait_for_exit;
+
+    inline constexpr const char PORT[] = "19736";
+
+    inline constexpr std::string_view BOARD
+        = "ID: 0, From: 127.0.0.1, Reaction: [HAPPY], Happy: 1, Sad: 0, Msg: \"one\"\n"
+          "ID: 1, From: 127.0.0.1, Reaction: [], Happy: 0, Sad: 0, Msg: \"two\"\n";
+
+    auto expect(std::string_view what, const std::string &reply, std::string_view expected)
+        -> bool
+    {
+        if (reply != expected)
+        {
+            std::cerr << what << " replied:\n" << reply;
+            return false;
+        }
+        return true;
+    }
+
+    auto send_text(int fd, std::string_view text) -> bool
+    {
+        return send(fd, text.data(), text.size(), MSG_NOSIGNAL)
+            == static_cast<ssize_t>(text.size());
+    }
+
+    // Starts a server taking over from `old_server` through `socket_path`,
+    // listening on `next_socket_path` for the next takeover if one is given,
+    // and waits for the old one to exit. `old_server` is -1 once reaped.
+    auto take_over(
+        const char        *binary,
+        const std::string &socket_path,
+        const std::string &next_socket_path,
+        pid_t             &old_server,
+        pid_t             &new_server
+    ) -> bool
+    {
+        std::vector<const char *> arguments
+            = { PORT, "--takeover", socket_path.c_str(), "--takeover-clients" };
+        if (!next_socket_path.empty())
+        {
+            arguments.push_back("--handoff-socket");
+            arguments.push_back(next_socket_path.c_str());
+        }
+        new_server = spawn(binary, arguments);
+
+        std::optional<int> status = wait_for_exit(old_server);
+        if (!status)
+        {
+            std::cerr << "server " << old_server << " kept running after handing off\n";
+            return false;
+        }
+        old_server = -1;
+        if (*status != 0)
+        {
+            std::cerr << "server exited with " << *status << " after handing off\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <server binary>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Separate paths, so one generation's cleanup cannot race the next
+    // one's bind.
+    std::string prefix      = "/tmp/oreore-test-handoff-" + std::to_string(getpid());
+    std::string first_path  = prefix + "-1.sock";
+    std::string second_path = prefix + "-2.sock";
+
+    pid_t first   = spawn(argv[1], { PORT, "--handoff-socket", first_path.c_str() });
+    pid_t second  = -1;
+    pid_t third   = -1;
+    int   idle    = connect_with_retry(PORT);
+    int   partial = connect_with_retry(PORT);
+
+    bool passed
+        = idle >= 0 && partial >= 0
+       && expect(
+              "POST and HAPPY",
+              exchange(idle, "POST one\nHAPPY 0\n", 2),
+              "OK: Message 0 posted.\nOK: Reaction set for message 0.\n"
+          )
+       && send_text(partial, "POS")
+       && take_over(argv[1], first_path, second_path, first, second)
+       && expect("split POST", exchange(partial, "T two\n", 1), "OK: Message 1 posted.\n")
+       && send_text(partial, "GE")
+       && take_over(argv[1], second_path, "", second, third)
+       && expect("split GET", exchange(partial, "T\n", 2), BOARD)
+       && expect("idle client's GET", exchange(idle, "GET\n", 2), BOARD);
+
+    int fresh = passed ? connect_with_retry(PORT) : -1;
+    passed    = passed && fresh >= 0
+          && expect("new client's GET", exchange(fresh, "GET\n", 2), BOARD);
+
+    close(fresh);
+    close(partial);
+    close(idle);
+    for (pid_t server : { first, second, third })
+    {
+        if (server > 0)
+        {
+            kill(server, SIGTERM);
+            waitpid(server, nullptr, 0);
+        }
+    }
+    unlink(first_path.c_str());
+    unlink(second_path.c_str());
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,130 @@
+// The overload controller's buffered-bytes total is kept in step as buffers
+// fill and drain rather than summed from scratch. A client that stops reading
+// large GET replies and leaves half a command behind must show up in STATS,
+// and once it disconnects and the rest of the traffic is answered, the total
+// must come back to exactly zero.
+//
+//   overload_buffered_bytes <server binary>
+
+#include "test_process.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    using test_process::connect_with_retry;
+    using test_process::exchange;
+    using test_process::spawn;
+
+    inline constexpr const char PORT[]     = "19737";
+    inline constexpr size_t     BOARD_SIZE = 3000;
+    // Enough full GETs to outgrow the loopback socket buffers.
+    inline constexpr size_t UNREAD_GETS = 40;
+
+    // Reads overload.buffered_bytes from STATS until `done` accepts it, which
+    // may take a few samples; returns the last value seen.
+    template<typename predicate>
+    auto watch_buffered_bytes(int fd, predicate done) -> size_t
+    {
+        constexpr std::string_view KEY = "overload.buffered_bytes: ";
+
+        size_t bytes    = 0;
+        auto   deadline = std::chrono::steady_clock::now() + test_process::TIMEOUT;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            // The reply always ends with the pool.oversize_in_use line.
+            std::string reply = exchange(fd, "STATS\n", 1);
+            while (reply.find("pool.oversize_in_use") == std::string::npos
+                   || !reply.ends_with("\n"))
+            {
+                size_t received = reply.size();
+                test_process::receive_at_least(fd, reply, received + 1);
+                if (reply.size() == received)
+                {
+                    return bytes;
+                }
+            }
+            size_t start = reply.find(KEY);
+            if (start == std::string::npos)
+            {
+                return bytes;
+            }
+            bytes = std::stoul(reply.substr(start + KEY.size()));
+            if (done(bytes))
+            {
+                return bytes;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return bytes;
+    }
+
+    auto run(int observer, int hoarder) -> bool
+    {
+        std::string posts = "MPOST " + std::to_string(BOARD_SIZE) + "\n";
+        for (size_t index = 0; index < BOARD_SIZE; ++index)
+        {
+            posts += "buffered " + std::to_string(index) + "\n";
+        }
+        if (!exchange(observer, posts, 1).starts_with("OK:"))
+        {
+            std::cerr << "MPOST failed\n";
+            return false;
+        }
+
+        std::string requests;
+        for (size_t index = 0; index < UNREAD_GETS; ++index)
+        {
+            requests += "GET\n";
+        }
+        requests += "POS";
+        send(hoarder, requests.data(), requests.size(), MSG_NOSIGNAL);
+
+        auto   some = [](size_t bytes) { return bytes > 0; };
+        size_t held = watch_buffered_bytes(observer, some);
+        if (held == 0)
+        {
+            std::cerr << "unread replies never showed up as buffered bytes\n";
+            return false;
+        }
+
+        close(hoarder);
+        auto   none = [](size_t bytes) { return bytes == 0; };
+        size_t left = watch_buffered_bytes(observer, none);
+        if (left != 0)
+        {
+            std::cerr << left << " bytes still counted as buffered after the client left\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <server binary>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    pid_t server   = spawn(argv[1], { PORT });
+    int   observer = connect_with_retry(PORT);
+    int   hoarder  = connect_with_retry(PORT);
+
+    bool passed = observer >= 0 && hoarder >= 0 && run(observer, hoarder);
+
+    close(observer);
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+// Posts messages holding '"', '\' and a tab, then searches for them. Stored
+// text is escaped, so SEARCH has to escape its term the same way, both for
+// short terms (a scan) and for terms long enough for the trigram index.
+//
+//   search_escaping <server binary>
+
+#include "test_process.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    using test_process::connect_with_retry;
+    using test_process::exchange;
+    using test_process::spawn;
+
+    inline constexpr const char PORT[] = "19733";
+
+    // A search's matching lines must hold `expected` and nothing else.
+    auto finds(int fd, std::string_view term, std::string_view expected) -> bool
+    {
+        std::string reply = exchange(fd, "SEARCH " + std::string(term) + "\n", 1);
+        if (!reply.starts_with("ID:") || reply.find(expected) == std::string::npos)
+        {
+            std::cerr << "SEARCH " << term << " replied: " << reply;
+            return false;
+        }
+        return true;
+    }
+
+    auto run(int fd) -> bool
+    {
+        for (std::string_view text : {
+                 R"(say "hello" there)",
+                 R"(C:\path\to)",
+                 "tab\tseparated",
+             })
+        {
+            std::string reply = exchange(fd, "POST " + std::string(text) + "\n", 1);
+            if (!reply.starts_with("OK:"))
+            {
+                std::cerr << "POST " << text << " replied: " << reply;
+                return false;
+            }
+        }
+
+        return finds(fd, R"("hello")", "say")
+            && finds(fd, R"(o")", "say")
+            && finds(fd, R"(\)", "path")
+            && finds(fd, R"(\path\)", "path")
+            && finds(fd, "tab", "separated");
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <server binary>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    pid_t server = spawn(argv[1], { PORT });
+    int   fd     = connect_with_retry(PORT);
+
+    bool passed = fd >= 0 && run(fd);
+
+    close(fd);
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
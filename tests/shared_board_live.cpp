@@ -0,0 +1,210 @@
+// Reads a --shm-board mirror over and over while a client posts and reacts
+// through the server. Every read must be consistent on its own: positions
+// match IDs, texts are whole, the message count and board version never go
+// back, and reactions only ever show a finished update. Once the writer is
+// done, the board must hold exactly what was posted.
+//
+//   shared_board_live <server binary>
+
+#include "test_process.hpp"
+
+#include <oreore/shared_board_reader.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    using oreore::shared_board_message;
+    using oreore::shared_board_reader;
+    using test_process::connect_with_retry;
+    using test_process::exchange;
+    using test_process::spawn;
+
+    inline constexpr const char PORT[]        = "19735";
+    inline constexpr size_t     BATCHES       = 40;
+    inline constexpr size_t     BATCH_SIZE    = 100;
+    inline constexpr size_t     MESSAGE_COUNT = BATCHES * BATCH_SIZE;
+    // One message in this many gets a HAPPY while the reader runs.
+    inline constexpr size_t REACTION_EVERY = 10;
+
+    auto expected_text(uint64_t id) -> std::string
+    {
+        return "live " + std::to_string(id);
+    }
+
+    auto write_board(int fd) -> bool
+    {
+        uint64_t next_id = 0;
+        for (size_t batch = 0; batch < BATCHES; ++batch)
+        {
+            std::string posts = "MPOST " + std::to_string(BATCH_SIZE) + "\n";
+            for (size_t index = 0; index < BATCH_SIZE; ++index)
+            {
+                posts += expected_text(next_id++) + "\n";
+            }
+            if (!exchange(fd, posts, 1).starts_with("OK:"))
+            {
+                return false;
+            }
+            for (uint64_t id = next_id - BATCH_SIZE; id < next_id; id += REACTION_EVERY)
+            {
+                std::string reaction = "HAPPY " + std::to_string(id) + "\n";
+                if (!exchange(fd, reaction, 1).starts_with("OK:"))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    auto check_message(const shared_board_message &message, uint64_t position) -> bool
+    {
+        bool reacted        = message.reaction != 0 || message.happy != 0;
+        bool reaction_whole = message.reaction == (message.happy != 0 ? 1 : 0)
+                           && message.happy <= 1 && message.sad == 0;
+        if (message.id != position || message.text != expected_text(position)
+            || message.sender != "127.0.0.1" || !reaction_whole
+            || (reacted && position % REACTION_EVERY != 0))
+        {
+            std::cerr << "inconsistent message at " << position << ": id " << message.id
+                      << " text \"" << message.text << "\" reaction " << message.reaction
+                      << " happy " << message.happy << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    auto open_board(const std::string &name) -> std::optional<shared_board_reader>
+    {
+        auto deadline = std::chrono::steady_clock::now() + test_process::TIMEOUT;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (auto reader = shared_board_reader::open(name))
+            {
+                return std::move(*reader);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return std::nullopt;
+    }
+
+    auto read_while_written(
+        const shared_board_reader &reader,
+        const std::atomic<bool>   &done
+    ) -> bool
+    {
+        std::vector<shared_board_message> seen;
+        uint64_t                          last_version = 0;
+        size_t                            reads        = 0;
+        while (true)
+        {
+            bool     writer_done = done.load();
+            uint64_t version     = reader.version();
+            if (version < last_version)
+            {
+                std::cerr << "board version went back\n";
+                return false;
+            }
+            last_version = version;
+
+            // Alternate full reads with incremental ones plus a reaction
+            // refresh, the two ways a reader keeps up.
+            if (reads++ % 2 == 0)
+            {
+                std::vector<shared_board_message> full = reader.read();
+                if (full.size() < seen.size())
+                {
+                    std::cerr << "message count went back\n";
+                    return false;
+                }
+                seen = std::move(full);
+            }
+            else
+            {
+                reader.refresh_reactions(seen, 0);
+                for (shared_board_message &message : reader.read(seen.size()))
+                {
+                    seen.push_back(std::move(message));
+                }
+            }
+            for (size_t position = 0; position < seen.size(); ++position)
+            {
+                if (!check_message(seen[position], position))
+                {
+                    return false;
+                }
+            }
+
+            // One more pass after the writer finished sees its last update.
+            if (writer_done)
+            {
+                break;
+            }
+        }
+
+        for (size_t position = 0; position < seen.size(); ++position)
+        {
+            if ((position % REACTION_EVERY == 0) != (seen[position].happy == 1))
+            {
+                std::cerr << "final reaction missing at " << position << "\n";
+                return false;
+            }
+        }
+        if (seen.size() != MESSAGE_COUNT || reader.truncated() || reader.retired())
+        {
+            std::cerr << "final board holds " << seen.size() << " messages\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <server binary>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string board_name = "/oreore-test-board-" + std::to_string(getpid());
+    pid_t       server     = spawn(argv[1], { PORT, "--shm-board", board_name.c_str() });
+    int         fd         = connect_with_retry(PORT);
+    auto        reader     = open_board(board_name);
+
+    bool passed = false;
+    if (fd >= 0 && reader)
+    {
+        std::atomic<bool> done   = false;
+        bool              posted = false;
+        std::thread       writer(
+            [&]
+            {
+                posted = write_board(fd);
+                // The loop publishes before it next sleeps, so this reply
+                // means the board is current.
+                exchange(fd, "STATS\n", 1);
+                done = true;
+            }
+        );
+        bool consistent = read_while_written(*reader, done);
+        writer.join();
+        passed = posted && consistent;
+    }
+
+    close(fd);
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
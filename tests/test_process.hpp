@@ -0,0 +1,131 @@
+// Helpers shared by the end-to-end checks: start a server process, connect
+// to it over loopback, and exchange request/reply text.
+
+#ifndef OREORE_TEST_PROCESS_HPP
+#define OREORE_TEST_PROCESS_HPP
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace test_process
+{
+    inline constexpr auto TIMEOUT = std::chrono::seconds(5);
+
+    // Starts `binary` with `arguments`, its stdout sent to /dev/null.
+    inline auto spawn(const char *binary, std::vector<const char *> arguments) -> pid_t
+    {
+        arguments.insert(arguments.begin(), binary);
+        arguments.push_back(nullptr);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            int null_fd = open("/dev/null", O_WRONLY);
+            dup2(null_fd, STDOUT_FILENO);
+            execv(binary, const_cast<char *const *>(arguments.data()));
+            _exit(127);
+        }
+        return pid;
+    }
+
+    // Waits for `pid` to exit and returns its exit status; std::nullopt if
+    // it is still running after TIMEOUT or was killed by a signal.
+    inline auto wait_for_exit(pid_t pid) -> std::optional<int>
+    {
+        auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            int status = 0;
+            if (waitpid(pid, &status, WNOHANG) == pid)
+            {
+                if (!WIFEXITED(status))
+                {
+                    return std::nullopt;
+                }
+                return WEXITSTATUS(status);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return std::nullopt;
+    }
+
+    // Connects to 127.0.0.1:port, retrying until the server is listening;
+    // -1 after TIMEOUT. Reads on the socket time out after TIMEOUT too.
+    inline auto connect_with_retry(const char *port) -> int
+    {
+        sockaddr_in address {};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(static_cast<uint16_t>(std::atoi(port)));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+            {
+                timeval timeout { TIMEOUT.count(), 0 };
+                setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                return fd;
+            }
+            close(fd);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return -1;
+    }
+
+    // Reads until `reply` holds at least `bytes` bytes, or the peer closes
+    // or times out.
+    inline auto receive_at_least(int fd, std::string &reply, size_t bytes) -> void
+    {
+        char chunk[4096];
+        while (reply.size() < bytes)
+        {
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0)
+            {
+                break;
+            }
+            reply.append(chunk, static_cast<size_t>(received));
+        }
+    }
+
+    // Sends `request` and reads until the reply holds `lines` complete lines.
+    inline auto exchange(int fd, std::string_view request, size_t lines) -> std::string
+    {
+        send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+        std::string reply;
+        char        chunk[4096];
+        while (static_cast<size_t>(std::count(reply.begin(), reply.end(), '\n')) < lines)
+        {
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0)
+            {
+                break;
+            }
+            reply.append(chunk, static_cast<size_t>(received));
+        }
+        return reply;
+    }
+
+    // Whether the server closed the connection (recv sees EOF or a reset).
+    inline auto peer_closed(int fd) -> bool
+    {
+        char    byte;
+        ssize_t received = recv(fd, &byte, 1, 0);
+        return received == 0 || (received < 0 && errno == ECONNRESET);
+    }
+}
+
+#endif
@@ -0,0 +1,867 @@
+// Re-drives a server with traffic captured by --record and reports the
+// latency and throughput it saw, optionally against an earlier run.
+//
+//   oreore-replay <record file> <host:port> [options]
+//
+// Every recorded connection gets its own connection, and commands go out
+// in recorded order, either at the recorded pace (scaled by --speed) or as
+// fast as possible. Text commands are re-tagged "#r<n>" and binary frames
+// get request ID n, so each reply can be matched to its command; latency
+// runs from sending a command to the first line or frame of its reply.
+
+#include <oreore/message.hpp>
+#include <oreore/traffic_record.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    inline constexpr std::string_view REPLAY_TAG_PREFIX = "#r";
+    // How long to wait for outstanding replies once everything is sent.
+    inline constexpr auto DRAIN_TIMEOUT = std::chrono::seconds(5);
+
+    enum class step_role : uint8_t
+    {
+        connect,    // open the connection
+        disconnect, // half-close it once its replies are in
+        request,    // measured: a reply is expected under `key`
+        handshake,  // measured; replies after this one are binary frames
+        batch_open, // BATCH/MPOST: replied to under `key` once the body ends
+        batch_line, // body line; the batch's reply clock restarts
+        batch_end,  // last body line; the batch's reply is now due
+        unmatched,  // sent, but its reply carries no tag to match
+    };
+
+    struct replay_step
+    {
+        step_role   role;
+        uint32_t    connection;
+        uint64_t    at_us; // since the first record
+        uint32_t    key;
+        std::string bytes;
+    };
+
+    struct replay_plan
+    {
+        std::vector<replay_step> steps;
+        size_t                   connections = 0;
+        // COMPRESS and REPLICATE change what a connection receives, so they
+        // and everything after a REPLICATE are left out.
+        size_t dropped = 0;
+    };
+
+    enum class batch_state : uint8_t
+    {
+        none,
+        batch,
+        mpost,
+    };
+
+    // Per recorded connection while building the plan.
+    struct stream_state
+    {
+        bool        abandoned = false;
+        batch_state batch     = batch_state::none;
+        size_t      remaining = 0;
+        uint32_t    batch_key = 0;
+    };
+
+    auto read_file(const std::string &path) -> std::optional<std::string>
+    {
+        std::ifstream      input(path, std::ios::binary);
+        std::ostringstream contents;
+        if (!input || !(contents << input.rdbuf()))
+        {
+            return std::nullopt;
+        }
+        return contents.str();
+    }
+
+    // Turns one recorded text line into the step to send, if any.
+    auto plan_text_step(
+        replay_plan     &plan,
+        stream_state    &stream,
+        replay_step      step,
+        std::string_view line,
+        uint32_t        &next_key
+    ) -> void
+    {
+        if (stream.batch != batch_state::none)
+        {
+            bool last = stream.batch == batch_state::batch ? line == "END"
+                                                           : --stream.remaining == 0;
+            if (last)
+            {
+                stream.batch = batch_state::none;
+            }
+            step.role  = last ? step_role::batch_end : step_role::batch_line;
+            step.key   = stream.batch_key;
+            step.bytes = std::string(line) + "\n";
+            plan.steps.push_back(std::move(step));
+            return;
+        }
+
+        // The client's own tag is replaced by ours.
+        std::string_view body = line;
+        if (body.starts_with('#'))
+        {
+            size_t tag_end = body.find(' ');
+            if (tag_end == std::string_view::npos)
+            {
+                // Rejected by the server without a tag to match; send as is.
+                step.role  = step_role::unmatched;
+                step.bytes = std::string(line) + "\n";
+                plan.steps.push_back(std::move(step));
+                return;
+            }
+            body = body.substr(body.find_first_not_of(' ', tag_end));
+        }
+        std::istringstream arguments { std::string(body) };
+        std::string        command_token;
+        arguments >> command_token;
+
+        if (command_token == "COMPRESS")
+        {
+            ++plan.dropped;
+            return;
+        }
+        if (command_token == "REPLICATE")
+        {
+            ++plan.dropped;
+            stream.abandoned = true;
+            return;
+        }
+
+        step.key   = next_key++;
+        step.role  = step_role::request;
+        step.bytes = std::string(REPLAY_TAG_PREFIX) + std::to_string(step.key) + " "
+                   + std::string(body) + "\n";
+        if (command_token == "BATCH")
+        {
+            step.role        = step_role::batch_open;
+            stream.batch     = batch_state::batch;
+            stream.batch_key = step.key;
+        }
+        else if (command_token == "MPOST")
+        {
+            size_t count = 0;
+            if (arguments >> count && count > 0 && count <= oreore::MAX_BATCH_SIZE)
+            {
+                step.role        = step_role::batch_open;
+                stream.batch     = batch_state::mpost;
+                stream.remaining = count;
+                stream.batch_key = step.key;
+            }
+        }
+        else if (command_token == oreore::BINARY_HANDSHAKE_LINE)
+        {
+            step.role = step_role::handshake;
+        }
+        plan.steps.push_back(std::move(step));
+    }
+
+    auto make_plan(std::string_view recording)
+        -> std::optional<replay_plan>
+    {
+        if (!recording.starts_with(oreore::TRAFFIC_MAGIC))
+        {
+            return std::nullopt;
+        }
+        recording.remove_prefix(oreore::TRAFFIC_MAGIC.size());
+
+        replay_plan               plan;
+        std::vector<stream_state> streams;
+        uint64_t                  at_us    = 0;
+        uint32_t                  next_key = 0;
+        while (auto record = oreore::decode_traffic_record(recording))
+        {
+            recording.remove_prefix(
+                oreore::TRAFFIC_RECORD_HEADER_SIZE + record->payload.size()
+            );
+            at_us += record->delay_us;
+            if (record->connection >= streams.size())
+            {
+                streams.resize(record->connection + 1);
+            }
+            stream_state &stream = streams[record->connection];
+            replay_step   step { step_role::connect, record->connection, at_us, 0, {} };
+
+            switch (record->kind)
+            {
+                case oreore::traffic_kind::open:
+                    plan.steps.push_back(std::move(step));
+                    break;
+                case oreore::traffic_kind::close:
+                    step.role = step_role::disconnect;
+                    plan.steps.push_back(std::move(step));
+                    break;
+                case oreore::traffic_kind::text:
+                    if (stream.abandoned)
+                    {
+                        ++plan.dropped;
+                        break;
+                    }
+                    plan_text_step(plan, stream, std::move(step), record->payload, next_key);
+                    break;
+                case oreore::traffic_kind::frame:
+                    if (stream.abandoned
+                        || record->payload.size() < oreore::BINARY_HEADER_SIZE)
+                    {
+                        ++plan.dropped;
+                        break;
+                    }
+                    step.role  = step_role::request;
+                    step.key   = next_key++;
+                    step.bytes = std::string(record->payload);
+                    oreore::store_le32(step.bytes.data() + 4, step.key);
+                    plan.steps.push_back(std::move(step));
+                    break;
+            }
+        }
+        plan.connections = streams.size();
+        return plan;
+    }
+
+    struct replay_connection
+    {
+        int         fd = -1;
+        std::string output;
+        std::string input;
+        // Set once the handshake's reply has been read.
+        bool                         binary_replies = false;
+        std::unordered_set<uint32_t> handshakes;
+        // Replies still pending; a recorded close waits for them, as the
+        // server drops commands it has not run when the client hangs up.
+        size_t awaiting = 0;
+        bool   closing  = false;
+    };
+
+    struct pending_reply
+    {
+        clock::time_point sent;
+        uint32_t          connection;
+        // Batch replies only become due when the body is complete.
+        bool due;
+    };
+
+    struct replay_summary
+    {
+        size_t                commands = 0;
+        double                seconds  = 0;
+        std::vector<uint64_t> latencies_us;
+        size_t                unanswered = 0;
+
+        [[nodiscard]] auto throughput(void) const -> double
+        {
+            return seconds > 0 ? static_cast<double>(commands) / seconds : 0;
+        }
+
+        [[nodiscard]] auto percentile(double fraction) const -> uint64_t
+        {
+            if (latencies_us.empty())
+            {
+                return 0;
+            }
+            size_t index = static_cast<size_t>(
+                fraction * static_cast<double>(latencies_us.size() - 1)
+            );
+            return latencies_us[index];
+        }
+
+        [[nodiscard]] auto metrics(void) const -> std::map<std::string, double>
+        {
+            return {
+                { "commands_per_second", throughput() },
+                { "latency_p50_us", static_cast<double>(percentile(0.50)) },
+                { "latency_p90_us", static_cast<double>(percentile(0.90)) },
+                { "latency_p99_us", static_cast<double>(percentile(0.99)) },
+                { "latency_max_us", static_cast<double>(percentile(1.0)) },
+            };
+        }
+    };
+
+    class replayer
+    {
+      private:
+        const replay_plan                         &plan;
+        addrinfo                                  *target;
+        int                                        epoll_fd;
+        std::vector<replay_connection>             connections;
+        std::unordered_map<uint32_t, pending_reply> pending;
+        size_t                                     due_replies;
+        replay_summary                             summary;
+
+        auto fail(const std::string &what) -> void
+        {
+            std::cerr << what << ": " << std::strerror(errno) << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        auto open_connection(uint32_t index) -> void
+        {
+            replay_connection &connection = connections[index];
+            connection.fd                 = socket(
+                target->ai_family,
+                target->ai_socktype | SOCK_CLOEXEC,
+                target->ai_protocol
+            );
+            if (connection.fd == -1
+                || connect(connection.fd, target->ai_addr, target->ai_addrlen) == -1)
+            {
+                fail("connect failed");
+            }
+            int enabled = 1;
+            setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+            fcntl(connection.fd, F_SETFL, fcntl(connection.fd, F_GETFL) | O_NONBLOCK);
+
+            epoll_event event {};
+            event.events   = EPOLLIN | EPOLLOUT | EPOLLET;
+            event.data.u32 = index;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, connection.fd, &event) == -1)
+            {
+                fail("epoll_ctl failed");
+            }
+        }
+
+        auto close_connection(uint32_t index) -> void
+        {
+            replay_connection &connection = connections[index];
+            close(connection.fd);
+            connection.fd = -1;
+            std::erase_if(
+                pending,
+                [&](const auto &entry)
+                {
+                    if (entry.second.connection != index)
+                    {
+                        return false;
+                    }
+                    ++summary.unanswered;
+                    due_replies -= entry.second.due;
+                    return true;
+                }
+            );
+            connection.awaiting = 0;
+            connection.closing  = false;
+        }
+
+        auto send_output(uint32_t index) -> void
+        {
+            replay_connection &connection = connections[index];
+            size_t             sent_total = 0;
+            while (sent_total < connection.output.size())
+            {
+                ssize_t sent = send(
+                    connection.fd,
+                    connection.output.data() + sent_total,
+                    connection.output.size() - sent_total,
+                    MSG_NOSIGNAL
+                );
+                if (sent == -1)
+                {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    {
+                        close_connection(index);
+                        return;
+                    }
+                    break;
+                }
+                sent_total += static_cast<size_t>(sent);
+            }
+            connection.output.erase(0, sent_total);
+            half_close_when_done(connection);
+        }
+
+        auto half_close_when_done(replay_connection &connection) -> void
+        {
+            if (connection.closing && connection.output.empty()
+                && connection.awaiting == 0)
+            {
+                shutdown(connection.fd, SHUT_WR);
+                connection.closing = false;
+            }
+        }
+
+        auto await_reply(uint32_t key, uint32_t index, bool due) -> void
+        {
+            pending[key] = pending_reply { clock::now(), index, due };
+            ++connections[index].awaiting;
+            due_replies += due;
+        }
+
+        auto reply_arrived(uint32_t key) -> void
+        {
+            auto pending_iterator = pending.find(key);
+            if (pending_iterator == pending.end())
+            {
+                return;
+            }
+            summary.latencies_us.push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    clock::now() - pending_iterator->second.sent
+                )
+                    .count()
+            ));
+            due_replies -= pending_iterator->second.due;
+            replay_connection &connection = connections[pending_iterator->second.connection];
+            pending.erase(pending_iterator);
+            --connection.awaiting;
+            half_close_when_done(connection);
+        }
+
+        // Matches the first line or frame of each reply; the rest of a
+        // reply carries a key that is no longer pending.
+        auto parse_replies(replay_connection &connection) -> void
+        {
+            std::string_view input(connection.input);
+            while (!connection.binary_replies)
+            {
+                size_t newline_pos = input.find('\n');
+                if (newline_pos == std::string_view::npos)
+                {
+                    break;
+                }
+                std::string_view line = input.substr(0, newline_pos);
+                input.remove_prefix(newline_pos + 1);
+                if (!line.starts_with(REPLAY_TAG_PREFIX))
+                {
+                    continue;
+                }
+                uint32_t key = 0;
+                auto [key_end, error] = std::from_chars(
+                    line.data() + REPLAY_TAG_PREFIX.size(),
+                    line.data() + line.size(),
+                    key
+                );
+                if (error != std::errc() || key_end == line.data() + line.size()
+                    || *key_end != ' ')
+                {
+                    continue;
+                }
+                reply_arrived(key);
+                if (connection.handshakes.contains(key))
+                {
+                    connection.binary_replies = true;
+                }
+            }
+            while (connection.binary_replies
+                   && input.size() >= oreore::BINARY_HEADER_SIZE)
+            {
+                uint32_t payload_length = oreore::load_le32(input.data() + 8);
+                if (input.size() - oreore::BINARY_HEADER_SIZE < payload_length)
+                {
+                    break;
+                }
+                reply_arrived(oreore::load_le32(input.data() + 4));
+                input.remove_prefix(oreore::BINARY_HEADER_SIZE + payload_length);
+            }
+            connection.input.erase(0, connection.input.size() - input.size());
+        }
+
+        auto receive(uint32_t index) -> void
+        {
+            replay_connection &connection = connections[index];
+            char               buffer[64 * 1024];
+            while (connection.fd != -1)
+            {
+                ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+                if (received > 0)
+                {
+                    connection.input.append(buffer, static_cast<size_t>(received));
+                    continue;
+                }
+                if (received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                {
+                    break;
+                }
+                parse_replies(connection);
+                close_connection(index);
+                return;
+            }
+            parse_replies(connection);
+        }
+
+        auto dispatch(const replay_step &step) -> void
+        {
+            replay_connection &connection = connections[step.connection];
+            if (step.role == step_role::connect)
+            {
+                open_connection(step.connection);
+                return;
+            }
+            if (connection.fd == -1)
+            {
+                return;
+            }
+            if (step.role == step_role::disconnect)
+            {
+                connection.closing = true;
+                send_output(step.connection);
+                return;
+            }
+
+            ++summary.commands;
+            switch (step.role)
+            {
+                case step_role::handshake:
+                    connection.handshakes.insert(step.key);
+                    [[fallthrough]];
+                case step_role::request:
+                    await_reply(step.key, step.connection, true);
+                    break;
+                case step_role::batch_open:
+                    await_reply(step.key, step.connection, false);
+                    break;
+                case step_role::batch_line:
+                case step_role::batch_end:
+                    if (auto pending_iterator = pending.find(step.key);
+                        pending_iterator != pending.end())
+                    {
+                        pending_iterator->second.sent = clock::now();
+                        if (step.role == step_role::batch_end
+                            && !pending_iterator->second.due)
+                        {
+                            pending_iterator->second.due = true;
+                            ++due_replies;
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+            connection.output.append(step.bytes);
+            send_output(step.connection);
+        }
+
+      public:
+        replayer(const replay_plan &replay, addrinfo *address)
+            : plan(replay)
+            , target(address)
+            , epoll_fd(epoll_create1(EPOLL_CLOEXEC))
+            , connections(replay.connections)
+            , due_replies(0)
+        {
+            if (epoll_fd == -1)
+            {
+                fail("epoll_create1 failed");
+            }
+        }
+
+        replayer(const replayer &)                     = delete;
+        auto operator=(const replayer &) -> replayer & = delete;
+
+        ~replayer(void)
+        {
+            for (replay_connection &connection : connections)
+            {
+                if (connection.fd != -1)
+                {
+                    close(connection.fd);
+                }
+            }
+            close(epoll_fd);
+        }
+
+        // speed 0 sends as fast as possible. In lockstep a step waits until
+        // every reply that is due has arrived. Either way, steps after a
+        // recorded close wait for that connection's replies, as the client
+        // had them before it hung up; this also keeps as many connections
+        // open at once as were recorded.
+        auto run(double speed, bool lockstep) -> replay_summary
+        {
+            auto                    start     = clock::now();
+            auto                    last_sent = start;
+            size_t                  next_step = 0;
+            std::optional<uint32_t> closing;
+            std::vector<epoll_event> events(oreore::MAX_EPOLL_EVENTS);
+            while (true)
+            {
+                auto now = clock::now();
+                int  timeout = -1;
+                while (next_step < plan.steps.size())
+                {
+                    if ((lockstep && due_replies > 0)
+                        || (closing && connections[*closing].closing))
+                    {
+                        break;
+                    }
+                    const replay_step &step = plan.steps[next_step];
+                    if (speed > 0)
+                    {
+                        auto due = start
+                                 + std::chrono::microseconds(static_cast<int64_t>(
+                                     static_cast<double>(step.at_us) / speed
+                                 ));
+                        if (due > now)
+                        {
+                            timeout = static_cast<int>(
+                                std::chrono::ceil<std::chrono::milliseconds>(due - now)
+                                    .count()
+                            );
+                            break;
+                        }
+                    }
+                    dispatch(step);
+                    ++next_step;
+                    if (step.role == step_role::disconnect)
+                    {
+                        closing = step.connection;
+                    }
+                    last_sent = clock::now();
+                }
+
+                if (next_step == plan.steps.size())
+                {
+                    if (due_replies == 0 || now - last_sent > DRAIN_TIMEOUT)
+                    {
+                        break;
+                    }
+                    timeout = static_cast<int>(
+                        std::chrono::ceil<std::chrono::milliseconds>(
+                            last_sent + DRAIN_TIMEOUT - now
+                        )
+                            .count()
+                    );
+                }
+
+                int ready = epoll_wait(epoll_fd, events.data(), oreore::MAX_EPOLL_EVENTS, timeout);
+                for (int i = 0; i < ready; ++i)
+                {
+                    uint32_t index = events[i].data.u32;
+                    if (connections[index].fd == -1)
+                    {
+                        continue;
+                    }
+                    if (events[i].events & EPOLLOUT)
+                    {
+                        send_output(index);
+                    }
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    {
+                        receive(index);
+                    }
+                }
+            }
+
+            summary.seconds = std::chrono::duration<double>(clock::now() - start).count();
+            summary.unanswered += due_replies;
+            std::sort(summary.latencies_us.begin(), summary.latencies_us.end());
+            return std::move(summary);
+        }
+    };
+
+    auto resolve_target(const std::string &address) -> addrinfo *
+    {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos)
+        {
+            return nullptr;
+        }
+        addrinfo  hints {};
+        addrinfo *resolved = nullptr;
+        hints.ai_socktype  = SOCK_STREAM;
+        std::string host   = address.substr(0, colon);
+        std::string port   = address.substr(colon + 1);
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &resolved) != 0)
+        {
+            return nullptr;
+        }
+        return resolved;
+    }
+
+    auto load_metrics(const std::string &path)
+        -> std::optional<std::map<std::string, double>>
+    {
+        std::ifstream input(path);
+        if (!input)
+        {
+            return std::nullopt;
+        }
+        std::map<std::string, double> metrics;
+        std::string                   name;
+        double                        value = 0;
+        while (input >> name >> value)
+        {
+            metrics[name] = value;
+        }
+        return metrics;
+    }
+}
+
+auto main(int argc, const char *argv[]) -> int
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <record file> <host:port> [--speed <factor|max>] "
+                     "[--lockstep] [--save <file>] [--compare <file>]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    double                     speed    = 1.0;
+    bool                       lockstep = false;
+    std::optional<std::string> save_path;
+    std::optional<std::string> compare_path;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string_view argument(argv[i]);
+        if (argument == "--speed" && i + 1 < argc)
+        {
+            std::string_view value(argv[++i]);
+            char            *end = nullptr;
+            speed = value == "max" ? 0.0 : std::strtod(argv[i], &end);
+            if (value != "max" && (end == argv[i] || *end != '\0' || speed <= 0))
+            {
+                std::cerr << "Invalid --speed value: " << value << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (argument == "--lockstep")
+        {
+            lockstep = true;
+        }
+        else if (argument == "--save" && i + 1 < argc)
+        {
+            save_path = argv[++i];
+        }
+        else if (argument == "--compare" && i + 1 < argc)
+        {
+            compare_path = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete option: " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto recording = read_file(argv[1]);
+    if (!recording)
+    {
+        std::cerr << "Cannot read " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    auto plan = make_plan(*recording);
+    if (!plan)
+    {
+        std::cerr << argv[1] << " is not a traffic recording." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::optional<std::map<std::string, double>> baseline;
+    if (compare_path)
+    {
+        baseline = load_metrics(*compare_path);
+        if (!baseline)
+        {
+            std::cerr << "Cannot read " << *compare_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    addrinfo *target = resolve_target(argv[2]);
+    if (!target)
+    {
+        std::cerr << "Cannot resolve " << argv[2] << "; expected host:port."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // At max speed many recorded connections overlap.
+    rlimit file_limit {};
+    if (getrlimit(RLIMIT_NOFILE, &file_limit) == 0)
+    {
+        file_limit.rlim_cur = file_limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &file_limit);
+    }
+
+    replay_summary summary;
+    {
+        replayer replay(*plan, target);
+        summary = replay.run(speed, lockstep);
+    }
+    freeaddrinfo(target);
+
+    std::cout << "Replayed " << summary.commands << " commands on "
+              << plan->connections << " connections in " << summary.seconds
+              << " s (" << summary.throughput() << " commands/s, ";
+    if (speed > 0)
+    {
+        std::cout << speed << "x";
+    }
+    else
+    {
+        std::cout << "max";
+    }
+    std::cout << " speed)." << std::endl;
+    std::cout << "Latency (us, " << summary.latencies_us.size()
+              << " replies): p50 " << summary.percentile(0.50) << ", p90 "
+              << summary.percentile(0.90) << ", p99 " << summary.percentile(0.99)
+              << ", max " << summary.percentile(1.0) << std::endl;
+    if (summary.unanswered > 0 || plan->dropped > 0)
+    {
+        std::cout << "Unanswered: " << summary.unanswered
+                  << ", not replayed (COMPRESS/REPLICATE): " << plan->dropped
+                  << std::endl;
+    }
+
+    auto metrics = summary.metrics();
+    if (baseline)
+    {
+        std::cout << "Compared with " << *compare_path << ":" << std::endl;
+        for (const auto &[name, value] : metrics)
+        {
+            auto base = baseline->find(name);
+            if (base == baseline->end())
+            {
+                continue;
+            }
+            std::cout << "  " << name << ": " << base->second << " -> " << value;
+            if (base->second != 0)
+            {
+                std::cout << " (" << std::showpos
+                          << (value - base->second) / base->second * 100
+                          << std::noshowpos << "%)";
+            }
+            std::cout << std::endl;
+        }
+    }
+    if (save_path)
+    {
+        std::ofstream output(*save_path);
+        for (const auto &[name, value] : metrics)
+        {
+            output << name << " " << value << "\n";
+        }
+        if (!output)
+        {
+            std::cerr << "Cannot write " << *save_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}